@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/batch_router.h"
+#include "../src/read_file.h"
+#include "../src/route_model.h"
+
+/**
+ * @brief Measures BatchRouter throughput in queries per second for increasing thread counts.
+ *
+ * Usage: batch_throughput [-f filename.osm] [-n queries]
+ * The queries are uniformly random start/end pairs from a fixed seed, so runs are comparable.
+ */
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    std::size_t query_count = 20000;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string_view{argv[i]} == "-f" && ++i < argc)
+            osm_data_file = argv[i];
+        else if (std::string_view{argv[i]} == "-n" && ++i < argc)
+            query_count = std::stoul(argv[i]);
+    }
+
+    auto data = ReadFile(osm_data_file);
+    if (!data)
+    {
+        std::cout << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+    RouteModel model{*data};
+
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> coordinate{0.f, 100.f};
+    std::vector<RouteQuery> queries(query_count);
+    for (auto &query : queries)
+        query = RouteQuery{{coordinate(rng), coordinate(rng)}, {coordinate(rng), coordinate(rng)}};
+
+    std::vector<unsigned> thread_counts;
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads < hardware; threads *= 2)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(hardware);
+
+    std::cout << "queries: " << query_count << "\n";
+    std::cout << "threads\tseconds\tqueries/s\tspeedup\n";
+    double single_qps = 0.0;
+    for (unsigned threads : thread_counts)
+    {
+        BatchRouter router{model, threads};
+        router.Route(std::vector<RouteQuery>(queries.begin(), queries.begin() + std::min<std::size_t>(100, query_count)));
+
+        auto begin = std::chrono::steady_clock::now();
+        auto results = router.Route(queries);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+        double qps = query_count / elapsed.count();
+        if (threads == 1)
+            single_qps = qps;
+        std::cout << threads << "\t" << elapsed.count() << "\t" << qps << "\t" << qps / single_qps << "\n";
+    }
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/cli_args.h"
+#include "../src/read_file.h"
+#include "../src/render.h"
+#include "../src/route_model.h"
+#include "../src/tile_pyramid.h"
+
+/**
+ * @brief Measures tile pyramid rendering throughput in tiles per second for increasing thread counts.
+ *
+ * Usage: tile_throughput [-f filename.osm] [-z max_zoom] [-o directory]
+ * Without -o the tiles are only rendered, which leaves out PNG encoding and disk writes.
+ */
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    TilePyramidOptions options;
+    options.max_zoom = 5;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string_view{argv[i]} == "-f" && ++i < argc)
+            osm_data_file = argv[i];
+        else if (std::string_view{argv[i]} == "-z" && ++i < argc)
+        {
+            if (!ParseUnsigned(argv[i], options.max_zoom) || options.max_zoom > kMaxTileZoom)
+            {
+                std::cout << "The max zoom must be a number from 0 to " << kMaxTileZoom << std::endl;
+                return 1;
+            }
+        }
+        else if (std::string_view{argv[i]} == "-o" && ++i < argc)
+            options.directory = argv[i];
+    }
+
+    auto data = ReadFile(osm_data_file);
+    if (!data)
+    {
+        std::cout << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+    RouteModel model{*data};
+    Render render{model, RoutePath{}};
+
+    std::vector<unsigned> thread_counts;
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads < hardware; threads *= 2)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(hardware);
+
+    std::cout << "max zoom: " << options.max_zoom << "\n";
+    std::cout << "threads\ttiles\tseconds\ttiles/s\tspeedup\n";
+    double single_rate = 0.0;
+    for (unsigned threads : thread_counts)
+    {
+        options.threads = threads;
+        auto stats = RenderTilePyramid(render, options);
+        if (threads == 1)
+            single_rate = stats.TilesPerSecond();
+        std::cout << threads << "\t" << stats.tiles << "\t" << stats.seconds << "\t" << stats.TilesPerSecond() << "\t"
+                  << stats.TilesPerSecond() / single_rate << "\n";
+    }
+}
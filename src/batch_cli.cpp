@@ -0,0 +1,172 @@
+#include "batch_cli.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <vector>
+#include "batch_router.h"
+#include "cli_args.h"
+#include "read_file.h"
+#include "route_model.h"
+#include "route_request.h"
+
+/**
+ * @brief Reads the batch options from the command line.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * @param options Receives the options that were given; the others keep their defaults.
+ * @return Batch if batch mode was requested with --batch, Invalid if --threads is not a number.
+ */
+BatchRequest ParseBatchOptions(int argc, const char **argv, BatchOptions &options)
+{
+    bool batch = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+        if (arg == "-f" && i + 1 < argc)
+            options.osm_data_file = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc)
+        {
+            options.input = argv[++i];
+            batch = true;
+        }
+        else if (arg == "--out" && i + 1 < argc)
+            options.output = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            if (!ParseUnsigned(argv[++i], options.threads))
+                return BatchRequest::Invalid;
+        }
+        else if (arg == "--largest-component")
+            options.largest_component = true;
+        else if (arg == "--build-report")
+            options.build_report = true;
+    }
+    return batch ? BatchRequest::Batch : BatchRequest::None;
+}
+
+/**
+ * @brief Routes a JSONL request file against a single loaded model.
+ *
+ * Requests are streamed in chunks, so memory use does not grow with the size of the input. Every chunk
+ * is routed in parallel by a BatchRouter and written back in input order. Lines that are not valid
+ * requests produce an error line instead of stopping the run; blank lines are skipped.
+ *
+ * @param options The batch options.
+ * @return 0 on success, 1 if the map or the files could not be opened or the map could not be parsed.
+ */
+int RunBatch(const BatchOptions &options)
+{
+    constexpr std::size_t kChunkSize = 4096;
+
+    auto data = ReadFile(options.osm_data_file);
+    if (!data)
+    {
+        std::cerr << "Failed to read OpenStreetMap data from " << options.osm_data_file << std::endl;
+        return 1;
+    }
+
+    std::ifstream input_file;
+    if (options.input != "-")
+    {
+        input_file.open(options.input);
+        if (!input_file)
+        {
+            std::cerr << "Failed to open " << options.input << std::endl;
+            return 1;
+        }
+    }
+    std::ofstream output_file;
+    if (options.output != "-")
+    {
+        output_file.open(options.output);
+        if (!output_file)
+        {
+            std::cerr << "Failed to open " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::istream &input = options.input != "-" ? input_file : std::cin;
+    std::ostream &output = options.output != "-" ? output_file : std::cout;
+    output.precision(7);
+
+    auto begin = std::chrono::steady_clock::now();
+    BuildReport report;
+    report.Phase("parse osm");
+    std::optional<RouteModel> model;
+    try
+    {
+        model.emplace(*data, options.threads, &report);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to load " << options.osm_data_file << ": " << e.what() << std::endl;
+        return 1;
+    }
+    BatchRouter router{*model, options.threads, options.largest_component};
+    std::chrono::duration<double> load_time = std::chrono::steady_clock::now() - begin;
+    if (options.build_report)
+        report.Print(std::cerr);
+
+    // One entry per non-blank line; invalid lines keep their error message instead of a query slot.
+    struct Line
+    {
+        RouteRequest request;
+        std::string error;
+        std::size_t query = 0;
+    };
+    std::vector<Line> lines;
+    std::vector<RouteQuery> queries;
+    std::size_t line_number = 0, routed = 0, failed = 0;
+
+    auto flush = [&]()
+    {
+        auto paths = router.Route(queries);
+        for (const auto &line : lines)
+        {
+            if (!line.error.empty())
+            {
+                WriteRouteError(output, line.request.id, line.error);
+                ++failed;
+                continue;
+            }
+            WriteRouteResponse(output, line.request.id, paths[line.query], model->Graph());
+            ++(paths[line.query].Empty() ? failed : routed);
+        }
+        lines.clear();
+        queries.clear();
+    };
+
+    begin = std::chrono::steady_clock::now();
+    std::string text;
+    while (std::getline(input, text))
+    {
+        ++line_number;
+        if (text.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        Line &line = lines.emplace_back();
+        std::string error;
+        if (ParseRouteRequest(text, line.request, error))
+        {
+            line.query = queries.size();
+            queries.push_back(line.request.query);
+        }
+        else
+            line.error = "line " + std::to_string(line_number) + ": " + error;
+
+        if (lines.size() == kChunkSize)
+            flush();
+    }
+    flush();
+    output.flush();
+    std::chrono::duration<double> route_time = std::chrono::steady_clock::now() - begin;
+
+    std::cerr << "Loaded " << options.osm_data_file << " in " << load_time.count() << " s, routed " << routed
+              << " requests (" << failed << " failed) in " << route_time.count() << " s on " << router.Threads()
+              << " threads." << std::endl;
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef BATCH_CLI_H
+#define BATCH_CLI_H
+
+#include <string>
+
+/**
+ * Options of the headless batch mode.
+ */
+struct BatchOptions
+{
+  std::string osm_data_file = "../map.osm"; /**< The map to load. */
+  std::string input;                        /**< The JSONL request file, "-" for stdin. */
+  std::string output = "-";                 /**< The JSONL result file, "-" for stdout. */
+  unsigned threads = 0;                     /**< The number of routing threads, 0 for one per hardware thread. */
+  bool largest_component = false;           /**< Snap to the largest connected part of the road network only. */
+  bool build_report = false;                /**< Print the time of every load phase to stderr. */
+};
+
+/**
+ * What the command line asked for, as far as the batch options are concerned.
+ */
+enum class BatchRequest
+{
+  None,    /**< No --batch, the program should run in its normal mode. */
+  Batch,   /**< --batch was given, the program should run in batch mode. */
+  Invalid, /**< A batch option has a malformed value, the program should print its usage. */
+};
+
+/**
+ * Reads the batch options from the command line: [-f filename.osm] --batch requests.jsonl
+ * [--out results.jsonl] [--threads n] [--largest-component] [--build-report].
+ * @return Whether the program should run in batch mode, or Invalid if e.g. --threads is not a number.
+ */
+BatchRequest ParseBatchOptions(int argc, const char **argv, BatchOptions &options);
+
+/**
+ * Loads the map once and routes every request of the input file, writing one result line per request
+ * in input order. Nothing in batch mode touches the renderer.
+ * @return The process exit code.
+ */
+int RunBatch(const BatchOptions &options);
+
+#endif
@@ -0,0 +1,21 @@
+#include <iostream>
+#include "batch_cli.h"
+
+/**
+ * @brief Entry point of the headless batch router.
+ *
+ * This executable only links the routing code, so it runs on machines without X11 or io2d.
+ */
+int main(int argc, const char **argv)
+{
+    BatchOptions options;
+    if (ParseBatchOptions(argc, argv, options) != BatchRequest::Batch)
+    {
+        std::cout << "Usage: [executable] [-f filename.osm] --batch requests.jsonl [--out results.jsonl] [--threads n] "
+                     "[--largest-component] [--build-report]"
+                  << std::endl;
+        std::cout << "Each request line looks like {\"id\": 1, \"start\": [10, 10], \"end\": [90, 90]}." << std::endl;
+        return 1;
+    }
+    return RunBatch(options);
+}
@@ -0,0 +1,39 @@
+#include "batch_router.h"
+
+/**
+ * @brief Creates a router with its thread pool and per-worker workspaces.
+ *
+ * @param model The route model to answer queries on.
+ * @param threads The number of worker threads, 0 for one per hardware thread.
+ * @param largest_component Whether to snap to the largest connected component only.
+ */
+BatchRouter::BatchRouter(const RouteModel &model, unsigned threads, bool largest_component)
+    : m_Model(model), m_LargestComponent(largest_component), m_Pool(threads)
+{
+    m_Workspaces.resize(m_Pool.Size());
+}
+
+/**
+ * @brief Routes a batch of queries on all workers.
+ *
+ * Each query snaps its coordinates and runs an A* search with the workspace of the worker that picked
+ * it up. Results are written to the slot of the query, so the output keeps the input order no matter
+ * which worker finished first.
+ *
+ * @param queries The queries to answer.
+ * @return The path of every query.
+ */
+std::vector<RoutePath> BatchRouter::Route(const std::vector<RouteQuery> &queries)
+{
+    const RoadGraph &graph = m_Model.Graph();
+    std::vector<RoutePath> results(queries.size());
+
+    m_Pool.ParallelFor(queries.size(), [&](std::size_t i, unsigned worker)
+                       {
+        const auto &query = queries[i];
+        int start = graph.FindClosestNode(query.start.x * 0.01f, query.start.y * 0.01f, m_LargestComponent);
+        int end = graph.FindClosestNode(query.end.x * 0.01f, query.end.y * 0.01f, m_LargestComponent);
+        FindShortestPath(graph, start, end, m_Workspaces[worker], results[i]); });
+
+    return results;
+}
@@ -0,0 +1,52 @@
+#ifndef BATCH_ROUTER_H
+#define BATCH_ROUTER_H
+
+#include <vector>
+#include "graph_search.h"
+#include "route_model.h"
+#include "route_path.h"
+#include "thread_pool.h"
+
+/**
+ * A start/end pair in percent, as accepted by RoutePlanner.
+ */
+struct RouteQuery
+{
+  MapCoordinate start; /**< The start coordinates. */
+  MapCoordinate end;   /**< The end coordinates. */
+};
+
+/**
+ * @class BatchRouter
+ * @brief Answers many route queries in parallel against one loaded RouteModel.
+ *
+ * The router keeps a thread pool and one SearchWorkspace per worker for its whole lifetime, so a batch
+ * neither rebuilds the model nor allocates per query. The model is only read through its RoadGraph and
+ * has to outlive the router.
+ */
+class BatchRouter
+{
+public:
+  /**
+   * @param model The route model to answer queries on.
+   * @param threads The number of worker threads, 0 for one per hardware thread.
+   * @param largest_component Snap the query coordinates to the largest connected part of the road network.
+   */
+  BatchRouter(const RouteModel &model, unsigned threads = 0, bool largest_component = false);
+
+  unsigned Threads() const noexcept { return m_Pool.Size(); }
+
+  /**
+   * Routes every query of a batch.
+   * @return One path per query in the order of the input; empty paths mark unreachable queries.
+   */
+  std::vector<RoutePath> Route(const std::vector<RouteQuery> &queries);
+
+private:
+  const RouteModel &m_Model;
+  bool m_LargestComponent;
+  ThreadPool m_Pool;
+  std::vector<SearchWorkspace> m_Workspaces; /**< One workspace per pool worker. */
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "build_report.h"
+#include <algorithm>
+#include <iomanip>
+
+/**
+ * @brief Ends the current phase and starts a new one.
+ *
+ * @param name The name of the new phase.
+ */
+void BuildReport::Phase(std::string name)
+{
+    Finish();
+    m_Current = std::move(name);
+    m_Start = std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Ends the current phase and records its time.
+ */
+void BuildReport::Finish()
+{
+    if (m_Current.empty())
+        return;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_Start;
+    m_Phases.emplace_back(std::move(m_Current), elapsed.count());
+    m_Current.clear();
+}
+
+/**
+ * @brief Sums the times of the finished phases.
+ *
+ * @return The total in seconds.
+ */
+double BuildReport::TotalSeconds() const noexcept
+{
+    double total = 0.0;
+    for (const auto &phase : m_Phases)
+        total += phase.second;
+    return total;
+}
+
+/**
+ * @brief Writes the finished phases as a table.
+ *
+ * @param os The stream to write to.
+ */
+void BuildReport::Print(std::ostream &os) const
+{
+    const double total = TotalSeconds();
+    std::size_t width = 5;
+    for (const auto &phase : m_Phases)
+        width = std::max(width, phase.first.size());
+
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+    for (const auto &phase : m_Phases)
+        os << std::left << std::setw((int)width) << phase.first << std::right << std::setw(10) << phase.second * 1000.0
+           << " ms" << std::setw(7) << (total > 0.0 ? phase.second / total * 100.0 : 0.0) << " %\n";
+    os << std::left << std::setw((int)width) << "total" << std::right << std::setw(10) << total * 1000.0 << " ms\n";
+    os.flags(flags);
+    os.precision(precision);
+}
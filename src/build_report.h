@@ -0,0 +1,45 @@
+#ifndef BUILD_REPORT_H
+#define BUILD_REPORT_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class BuildReport
+ * @brief Wall-clock time of every phase of a model and graph build.
+ *
+ * A phase runs from its Phase() call to the next Phase() or Finish() call, so a caller can time work that
+ * happens before a constructor body runs (e.g. parsing the OSM data) by starting a phase of its own before
+ * it constructs the model.
+ */
+class BuildReport
+{
+public:
+  /**
+   * Ends the current phase, if any, and starts a new one.
+   */
+  void Phase(std::string name);
+
+  /**
+   * Ends the current phase, if any.
+   */
+  void Finish();
+
+  const std::vector<std::pair<std::string, double>> &Phases() const noexcept { return m_Phases; }
+  double TotalSeconds() const noexcept;
+
+  /**
+   * Writes one line per phase with its time in milliseconds and its share of the total.
+   */
+  void Print(std::ostream &os) const;
+
+private:
+  std::vector<std::pair<std::string, double>> m_Phases; /**< The name and seconds of every finished phase. */
+  std::string m_Current;                                /**< The running phase, empty if there is none. */
+  std::chrono::steady_clock::time_point m_Start;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef CLI_ARGS_H
+#define CLI_ARGS_H
+
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Parses a whole command line argument as an unsigned decimal number.
+ *
+ * Unlike std::stoul this never throws, and it rejects trailing characters, signs and out-of-range values, so
+ * a tool can print its usage instead of aborting on input like "--load abc".
+ *
+ * @param text The argument.
+ * @param value Receives the number; left unchanged on failure.
+ * @param min The smallest accepted value.
+ * @return True if the whole argument is a number of at least min that fits into T.
+ */
+template <typename T>
+bool ParseUnsigned(std::string_view text, T &value, T min = 0)
+{
+  static_assert(std::is_unsigned_v<T>, "ParseUnsigned parses unsigned numbers");
+  T parsed{};
+  auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+  if (text.empty() || error != std::errc{} || end != text.data() + text.size() || parsed < min)
+    return false;
+  value = parsed;
+  return true;
+}
+
+#endif
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "cli_args.h"
+#include "unix_socket.h"
+
+/**
+ * @brief Sends one request and waits for its response.
+ *
+ * @param fd The connected socket.
+ * @param reader The reader of the same socket.
+ * @param request The request line without newline.
+ * @param response Receives the response line.
+ * @return False if the connection failed.
+ */
+static bool RoundTrip(int fd, LineReader &reader, const std::string &request, std::string &response)
+{
+    return WriteAll(fd, request + "\n") && reader.ReadLine(response);
+}
+
+/**
+ * @brief Runs a closed-loop load test and prints latency percentiles.
+ *
+ * Every worker opens its own connection and sends random requests back to back, so the number of
+ * requests in flight equals the concurrency.
+ *
+ * @param socket_path The daemon socket.
+ * @param requests The total number of requests.
+ * @param concurrency The number of connections.
+ * @return The process exit code.
+ */
+static int RunLoad(const std::string &socket_path, std::size_t requests, unsigned concurrency)
+{
+    std::vector<std::vector<double>> latencies(concurrency);
+    std::vector<std::size_t> errors(concurrency, 0);
+    std::vector<std::thread> workers;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned w = 0; w < concurrency; ++w)
+        workers.emplace_back([&, w]()
+                             {
+            int fd = ConnectUnixSocket(socket_path);
+            if (fd < 0)
+            {
+                errors[w] = requests / concurrency;
+                return;
+            }
+            LineReader reader{fd};
+            std::mt19937 rng{w + 1};
+            std::uniform_real_distribution<float> coordinate{0.f, 100.f};
+            std::string response;
+            for (std::size_t i = w; i < requests; i += concurrency)
+            {
+                std::ostringstream request;
+                request << "{\"id\":" << i << ",\"start\":[" << coordinate(rng) << ',' << coordinate(rng)
+                        << "],\"end\":[" << coordinate(rng) << ',' << coordinate(rng) << "]}";
+                auto sent = std::chrono::steady_clock::now();
+                if (!RoundTrip(fd, reader, request.str(), response))
+                {
+                    ++errors[w];
+                    break;
+                }
+                std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - sent;
+                latencies[w].push_back(latency.count());
+                if (response.find("\"error\"") != std::string::npos)
+                    ++errors[w];
+            }
+            close(fd); });
+    for (auto &worker : workers)
+        worker.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    std::vector<double> all;
+    std::size_t error_count = 0;
+    for (unsigned w = 0; w < concurrency; ++w)
+    {
+        all.insert(all.end(), latencies[w].begin(), latencies[w].end());
+        error_count += errors[w];
+    }
+    if (all.empty())
+    {
+        std::cerr << "No request succeeded." << std::endl;
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p)
+    { return all[std::min(all.size() - 1, (std::size_t)(p * all.size()))]; };
+
+    std::cout << "requests: " << all.size() << " (" << error_count << " errors), concurrency: " << concurrency << "\n"
+              << "throughput: " << all.size() / elapsed.count() << " requests/s\n"
+              << "latency ms: p50 " << percentile(0.50) << ", p90 " << percentile(0.90) << ", p99 "
+              << percentile(0.99) << ", max " << all.back() << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Entry point of the routing daemon client.
+ *
+ * Usage:
+ *   route_client [--socket path] --start x y --end x y     send one query
+ *   route_client [--socket path]                           forward request lines from stdin
+ *   route_client [--socket path] --load n [--concurrency c] measure latency under load
+ */
+int main(int argc, const char **argv)
+{
+    std::string socket_path = "/tmp/route_planner.sock";
+    std::string start, end;
+    std::size_t load = 0;
+    unsigned concurrency = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+        if (arg == "--socket" && i + 1 < argc)
+            socket_path = argv[++i];
+        else if (arg == "--start" && i + 2 < argc)
+        {
+            start = std::string{argv[i + 1]} + "," + argv[i + 2];
+            i += 2;
+        }
+        else if (arg == "--end" && i + 2 < argc)
+        {
+            end = std::string{argv[i + 1]} + "," + argv[i + 2];
+            i += 2;
+        }
+        else if (arg == "--load" && i + 1 < argc && ParseUnsigned(argv[i + 1], load))
+            ++i;
+        else if (arg == "--concurrency" && i + 1 < argc && ParseUnsigned(argv[i + 1], concurrency, 1u))
+            ++i;
+        else
+        {
+            std::cout << "Usage: [executable] [--socket path] [--start x y --end x y | --load n [--concurrency c]]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (load > 0)
+        return RunLoad(socket_path, load, concurrency);
+
+    int fd = ConnectUnixSocket(socket_path);
+    if (fd < 0)
+    {
+        std::cerr << "Failed to connect to " << socket_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    LineReader reader{fd};
+    std::string response;
+
+    if (!start.empty() && !end.empty())
+    {
+        if (!RoundTrip(fd, reader, "{\"start\":[" + start + "],\"end\":[" + end + "]}", response))
+            return 1;
+        std::cout << response << std::endl;
+    }
+    else
+    {
+        std::string request;
+        while (std::getline(std::cin, request))
+        {
+            if (request.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+            if (!RoundTrip(fd, reader, request, response))
+                return 1;
+            std::cout << response << std::endl;
+        }
+    }
+    close(fd);
+    return 0;
+}
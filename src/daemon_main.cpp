@@ -0,0 +1,223 @@
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "cli_args.h"
+#include "graph_search.h"
+#include "route_service.h"
+#include "routing_engine.h"
+#include "unix_socket.h"
+
+// Longer request lines are answered with an error and the connection is closed.
+static constexpr std::size_t kMaxRequestLength = 64 * 1024;
+
+static std::atomic<bool> g_Stop{false};
+static std::atomic<bool> g_Reload{false};
+
+static void HandleSignal(int signal)
+{
+    if (signal == SIGHUP)
+        g_Reload = true;
+    else
+        g_Stop = true;
+}
+
+/**
+ * One client connection, served by its own thread with its own search workspace.
+ */
+struct Connection
+{
+    int fd = -1;
+    std::thread thread;
+    std::atomic<bool> done{false};
+};
+
+/**
+ * @brief Serves the requests of one connection until the client disconnects.
+ *
+ * A request line longer than kMaxRequestLength gets an error line, and the connection is then closed.
+ *
+ * @param connection The connection to serve.
+ * @param service The shared route service.
+ */
+static void Serve(Connection &connection, const RouteService &service)
+{
+    SearchWorkspace workspace;
+    LineReader reader{connection.fd, kMaxRequestLength};
+    std::string line;
+    while (!g_Stop && reader.ReadLine(line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        if (!WriteAll(connection.fd, service.Handle(line, workspace)))
+            break;
+    }
+    if (reader.LineTooLong())
+        WriteAll(connection.fd, "{\"id\":null,\"error\":\"request too long\"}\n");
+    connection.done = true;
+}
+
+/**
+ * @brief Entry point of the routing daemon.
+ *
+ * The daemon loads the map once, keeps its road graph resident and answers newline-delimited JSON route
+ * requests (see RouteRequest) on a Unix domain socket. Every connection is served concurrently by its
+ * own thread. SIGHUP reloads the map file in the background and swaps it in without interrupting queries;
+ * SIGINT and SIGTERM shut the daemon down cleanly.
+ *
+ * The map may be an OSM file or a graph image. With --write-image the daemon only converts the map into
+ * an image and exits; daemons started on that image map it read-only and share one copy of the graph.
+ *
+ * The initial load builds on every core. --reload-threads sets the threads of a SIGHUP reload, one by default
+ * so that the reload does not compete with the queries for the cores.
+ *
+ * --cache-mb puts a route cache of the given size in front of the search; it is emptied on every reload.
+ * --largest-component snaps all coordinates to the largest connected part of the road network, so that
+ * requests never end on a disconnected fragment. --build-report prints the time of every phase of the
+ * initial load.
+ *
+ * Usage: route_daemon [-f filename.osm|image] [--socket path] [--max-connections n] [--cache-mb n]
+ *                     [--reload-threads n] [--largest-component] [--build-report] [--write-image path]
+ */
+int main(int argc, const char **argv)
+{
+    std::string osm_data_file = "../map.osm";
+    std::string socket_path = "/tmp/route_planner.sock";
+    std::size_t max_connections = 256;
+    std::size_t cache_mb = 0;
+    unsigned reload_threads = 1;
+    bool largest_component = false;
+    bool build_report = false;
+    std::string image_file;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+        if (arg == "-f" && i + 1 < argc)
+            osm_data_file = argv[++i];
+        else if (arg == "--socket" && i + 1 < argc)
+            socket_path = argv[++i];
+        else if (arg == "--max-connections" && i + 1 < argc && ParseUnsigned<std::size_t>(argv[i + 1], max_connections, 1))
+            ++i;
+        else if (arg == "--cache-mb" && i + 1 < argc && ParseUnsigned(argv[i + 1], cache_mb))
+            ++i;
+        else if (arg == "--reload-threads" && i + 1 < argc && ParseUnsigned(argv[i + 1], reload_threads))
+            ++i;
+        else if (arg == "--largest-component")
+            largest_component = true;
+        else if (arg == "--build-report")
+            build_report = true;
+        else if (arg == "--write-image" && i + 1 < argc)
+            image_file = argv[++i];
+        else
+        {
+            std::cout << "Usage: [executable] [-f filename.osm|image] [--socket path] [--max-connections n] "
+                         "[--cache-mb n] [--reload-threads n] [--largest-component] [--build-report] [--write-image path]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    RoutingEngine engine;
+    BuildReport report;
+    if (!engine.Load(osm_data_file, &report))
+        return 1;
+    if (build_report)
+        report.Print(std::cerr);
+    if (!image_file.empty())
+    {
+        if (!engine.Acquire()->WriteImage(image_file))
+        {
+            std::cerr << "Failed to write " << image_file << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    std::unique_ptr<RouteCache> cache;
+    if (cache_mb > 0)
+        cache = std::make_unique<RouteCache>(cache_mb << 20);
+    RouteService service{engine, cache.get(), largest_component};
+
+    int listen_fd = ListenUnixSocket(socket_path, 128);
+    if (listen_fd < 0)
+    {
+        std::cerr << "Failed to listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGTERM, HandleSignal);
+    std::signal(SIGHUP, HandleSignal);
+    std::cerr << "Serving " << osm_data_file << " on " << socket_path << std::endl;
+
+    std::list<std::unique_ptr<Connection>> connections;
+    auto reap = [&]()
+    {
+        for (auto it = connections.begin(); it != connections.end();)
+        {
+            if ((*it)->done)
+            {
+                (*it)->thread.join();
+                close((*it)->fd);
+                it = connections.erase(it);
+            }
+            else
+                ++it;
+        }
+    };
+
+    // Poll with a timeout so that a signal is noticed even when no client connects.
+    while (!g_Stop)
+    {
+        if (g_Reload.exchange(false))
+        {
+            if (engine.ReloadAsync(osm_data_file, reload_threads))
+                std::cerr << "Reloading " << osm_data_file << std::endl;
+            else
+                std::cerr << "A reload is already running" << std::endl;
+        }
+        // Free a replaced graph once the last query that pinned it has finished.
+        engine.Reclaim();
+
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0)
+        {
+            reap();
+            continue;
+        }
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+
+        reap();
+        if (connections.size() >= max_connections)
+        {
+            WriteAll(fd, "{\"id\":null,\"error\":\"too many connections\"}\n");
+            close(fd);
+            continue;
+        }
+        auto &connection = connections.emplace_back(std::make_unique<Connection>());
+        connection->fd = fd;
+        connection->thread = std::thread(Serve, std::ref(*connection), std::cref(service));
+    }
+
+    // Wake up connections blocked in read and wait for them.
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    for (auto &connection : connections)
+        shutdown(connection->fd, SHUT_RDWR);
+    for (auto &connection : connections)
+    {
+        connection->thread.join();
+        close(connection->fd);
+    }
+    if (cache)
+        std::cerr << "Route cache: " << cache->Hits() << " hits, " << cache->Misses() << " misses, "
+                  << cache->Size() << " routes in " << cache->MemoryUsage() << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "distance_matrix.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "graph_search.h"
+
+/**
+ * Snaps a list of coordinates in percent to the closest routable nodes of a graph.
+ *
+ * @param graph The graph to snap to.
+ * @param coordinates The coordinates in percent.
+ * @return The node index for every coordinate.
+ */
+static std::vector<int> SnapAll(const RoadGraph &graph, const std::vector<MapCoordinate> &coordinates)
+{
+    std::vector<int> nodes;
+    nodes.reserve(coordinates.size());
+    for (const auto &c : coordinates)
+        nodes.push_back(graph.FindClosestNode(c.x * 0.01f, c.y * 0.01f));
+    return nodes;
+}
+
+/**
+ * @brief Computes the road distance between every source and every target.
+ *
+ * Sources are handed out to the workers through an atomic counter, so a few long searches do not hold
+ * back the other threads. Each worker writes only to the matrix rows of the sources it took.
+ *
+ * @param model The route model to search.
+ * @param sources The start coordinates in percent.
+ * @param targets The end coordinates in percent.
+ * @param threads The number of worker threads, 0 to use one per hardware thread.
+ * @return The distance matrix in meters.
+ */
+DistanceMatrix ComputeDistanceMatrix(const RouteModel &model, const std::vector<MapCoordinate> &sources,
+                                     const std::vector<MapCoordinate> &targets, unsigned threads)
+{
+    const RoadGraph &graph = model.Graph();
+    const auto source_nodes = SnapAll(graph, sources);
+    const auto target_nodes = SnapAll(graph, targets);
+    const auto scale = (float)model.MetricScale();
+
+    DistanceMatrix matrix{sources.size(), targets.size()};
+    if (sources.empty() || targets.empty())
+        return matrix;
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::min<std::size_t>(threads, sources.size());
+
+    std::atomic<std::size_t> next_source{0};
+    auto worker = [&]()
+    {
+        SearchWorkspace workspace;
+        for (std::size_t row = next_source++; row < sources.size(); row = next_source++)
+        {
+            float *distances = matrix.Row(row);
+            DistancesToTargets(graph, source_nodes[row], target_nodes, workspace, distances);
+            for (std::size_t col = 0; col < targets.size(); ++col)
+                distances[col] *= scale;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    return matrix;
+}
@@ -0,0 +1,48 @@
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <cstddef>
+#include <vector>
+#include "route_model.h"
+
+/**
+ * @class DistanceMatrix
+ * @brief Dense row-major table of travel distances in meters.
+ *
+ * Row i holds the distances from source i to every target. Pairs without a connecting road are
+ * reported as infinity.
+ */
+class DistanceMatrix
+{
+public:
+  DistanceMatrix(std::size_t rows, std::size_t cols) : m_Rows(rows), m_Cols(cols), m_Values(rows * cols) {}
+
+  std::size_t Rows() const noexcept { return m_Rows; }
+  std::size_t Cols() const noexcept { return m_Cols; }
+  float operator()(std::size_t row, std::size_t col) const noexcept { return m_Values[row * m_Cols + col]; }
+  float *Row(std::size_t row) noexcept { return m_Values.data() + row * m_Cols; }
+  const std::vector<float> &Values() const noexcept { return m_Values; }
+
+private:
+  std::size_t m_Rows;
+  std::size_t m_Cols;
+  std::vector<float> m_Values;
+};
+
+/**
+ * Computes the road distance between every source and every target.
+ *
+ * Every coordinate is snapped once to its closest routable node, then one Dijkstra search per source runs
+ * until all targets are settled. The sources are spread over a number of worker threads, each with its own
+ * SearchWorkspace, so the model is only read.
+ *
+ * @param model The route model to search.
+ * @param sources The start coordinates in percent, as accepted by RoutePlanner.
+ * @param targets The end coordinates in percent.
+ * @param threads The number of worker threads, 0 to use one per hardware thread.
+ * @return A sources.size() x targets.size() matrix of distances in meters.
+ */
+DistanceMatrix ComputeDistanceMatrix(const RouteModel &model, const std::vector<MapCoordinate> &sources,
+                                     const std::vector<MapCoordinate> &targets, unsigned threads = 0);
+
+#endif
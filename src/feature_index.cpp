@@ -0,0 +1,170 @@
+#include "feature_index.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Grows the box to contain a point.
+ *
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ */
+void BoundingBox::Extend(float x, float y) noexcept
+{
+    if (Empty())
+    {
+        min_x = max_x = x;
+        min_y = max_y = y;
+        return;
+    }
+    min_x = std::min(min_x, x);
+    min_y = std::min(min_y, y);
+    max_x = std::max(max_x, x);
+    max_y = std::max(max_y, y);
+}
+
+/**
+ * @brief Grows the box to contain another box.
+ *
+ * @param other The box to include; an empty box changes nothing.
+ */
+void BoundingBox::Extend(const BoundingBox &other) noexcept
+{
+    if (other.Empty())
+        return;
+    Extend(other.min_x, other.min_y);
+    Extend(other.max_x, other.max_y);
+}
+
+/**
+ * @brief Computes the bounding box of a way.
+ *
+ * @param model The model the way belongs to.
+ * @param way The way.
+ * @return The box, empty if the way has no nodes.
+ */
+BoundingBox WayBounds(const Model &model, const Model::Way &way)
+{
+    const auto &nodes = model.Nodes();
+    BoundingBox box;
+    for (int node : way.nodes)
+        box.Extend((float)nodes[node].x, (float)nodes[node].y);
+    return box;
+}
+
+/**
+ * @brief Computes the bounding box of a multipolygon.
+ *
+ * @param model The model the multipolygon belongs to.
+ * @param mp The multipolygon.
+ * @return The box of the outer and inner rings, empty if they have no nodes.
+ */
+BoundingBox MultipolygonBounds(const Model &model, const Model::Multipolygon &mp)
+{
+    const auto &ways = model.Ways();
+    BoundingBox box;
+    for (int way : mp.outer)
+        box.Extend(WayBounds(model, ways[way]));
+    for (int way : mp.inner)
+        box.Extend(WayBounds(model, ways[way]));
+    return box;
+}
+
+/**
+ * @brief Bulk-loads the tree with Sort-Tile-Recursive packing.
+ *
+ * @param boxes The box of every feature; the feature ids are the positions in this vector.
+ */
+FeatureIndex::FeatureIndex(std::vector<BoundingBox> boxes) : m_Boxes(std::move(boxes))
+{
+    for (int feature = 0; feature < Size(); ++feature)
+        if (!m_Boxes[feature].Empty())
+            m_Entries.push_back(feature);
+    if (m_Entries.empty())
+        return;
+
+    // Packs a level of items into nodes; `box_of` gives the box of an item, `items` is reordered in place.
+    auto pack = [&](std::vector<int> &items, auto &&box_of)
+    {
+        auto center_x = [&](int item)
+        { const BoundingBox &b = box_of(item); return b.min_x + b.max_x; };
+        auto center_y = [&](int item)
+        { const BoundingBox &b = box_of(item); return b.min_y + b.max_y; };
+
+        const std::size_t node_count = (items.size() + kNodeSize - 1) / kNodeSize;
+        const std::size_t slices = (std::size_t)std::ceil(std::sqrt((double)node_count));
+        const std::size_t slice_size = slices * kNodeSize;
+        std::stable_sort(items.begin(), items.end(), [&](int a, int b)
+                         { return center_x(a) < center_x(b); });
+        for (std::size_t begin = 0; begin < items.size(); begin += slice_size)
+        {
+            auto slice_begin = items.begin() + begin;
+            auto slice_end = items.begin() + std::min(items.size(), begin + slice_size);
+            std::stable_sort(slice_begin, slice_end, [&](int a, int b)
+                             { return center_y(a) < center_y(b); });
+            for (auto it = slice_begin; it < slice_end; it += std::min<std::ptrdiff_t>(kNodeSize, slice_end - it))
+            {
+                Node node{BoundingBox{}, (int)(it - items.begin()), (int)std::min<std::ptrdiff_t>(kNodeSize, slice_end - it)};
+                for (int i = 0; i < node.count; ++i)
+                    node.box.Extend(box_of(it[i]));
+                m_Nodes.push_back(node);
+            }
+        }
+    };
+
+    pack(m_Entries, [&](int feature) -> const BoundingBox &
+         { return m_Boxes[feature]; });
+    m_LeafCount = (int)m_Nodes.size();
+
+    // Pack every level into the next until a single root remains. The children of a node are kept
+    // contiguous by moving each level's nodes into packing order before their parents are created.
+    int level_begin = 0;
+    while ((int)m_Nodes.size() - level_begin > 1)
+    {
+        const int level_end = (int)m_Nodes.size();
+        std::vector<int> order(level_end - level_begin);
+        for (int i = 0; i < (int)order.size(); ++i)
+            order[i] = level_begin + i;
+        std::vector<Node> level(m_Nodes.begin() + level_begin, m_Nodes.end());
+        pack(order, [&](int node) -> const BoundingBox &
+             { return level[node - level_begin].box; });
+
+        // pack() appended the parents with `first` relative to `order`; place the children in that order.
+        for (int i = 0; i < (int)order.size(); ++i)
+            m_Nodes[level_begin + i] = level[order[i] - level_begin];
+        for (int parent = level_end; parent < (int)m_Nodes.size(); ++parent)
+            m_Nodes[parent].first += level_begin;
+        level_begin = level_end;
+    }
+}
+
+/**
+ * @brief Collects the features that intersect a view.
+ *
+ * @param view The view in normalized map units.
+ * @param result Receives the ids of the intersecting features in ascending order; previous contents are replaced.
+ */
+void FeatureIndex::Query(const BoundingBox &view, std::vector<int> &result) const
+{
+    result.clear();
+    if (m_Nodes.empty() || !m_Nodes.back().box.Intersects(view))
+        return;
+
+    std::vector<int> stack{(int)m_Nodes.size() - 1};
+    while (!stack.empty())
+    {
+        const Node &node = m_Nodes[stack.back()];
+        const bool leaf = stack.back() < m_LeafCount;
+        stack.pop_back();
+        for (int i = node.first; i < node.first + node.count; ++i)
+        {
+            if (leaf)
+            {
+                if (m_Boxes[m_Entries[i]].Intersects(view))
+                    result.push_back(m_Entries[i]);
+            }
+            else if (m_Nodes[i].box.Intersects(view))
+                stack.push_back(i);
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
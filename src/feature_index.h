@@ -0,0 +1,79 @@
+#ifndef FEATURE_INDEX_H
+#define FEATURE_INDEX_H
+
+#include <vector>
+#include "model.h"
+
+/**
+ * Axis-aligned rectangle in normalized map units. A default constructed box is empty and intersects nothing.
+ */
+struct BoundingBox
+{
+  float min_x = 1.f;
+  float min_y = 1.f;
+  float max_x = 0.f;
+  float max_y = 0.f;
+
+  bool Empty() const noexcept { return min_x > max_x || min_y > max_y; }
+  bool Intersects(const BoundingBox &other) const noexcept
+  {
+    return !Empty() && !other.Empty() && min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y &&
+           other.min_y <= max_y;
+  }
+
+  void Extend(float x, float y) noexcept;
+  void Extend(const BoundingBox &other) noexcept;
+};
+
+/**
+ * The bounding box of a way's nodes.
+ */
+BoundingBox WayBounds(const Model &model, const Model::Way &way);
+
+/**
+ * The bounding box of all rings of a multipolygon.
+ */
+BoundingBox MultipolygonBounds(const Model &model, const Model::Multipolygon &mp);
+
+/**
+ * @class FeatureIndex
+ * @brief Static R-tree over the bounding boxes of map features.
+ *
+ * The tree is bulk-loaded once with Sort-Tile-Recursive packing: the boxes are sorted into vertical slices
+ * by their center x, every slice is sorted by center y and cut into full nodes, and the same is repeated for
+ * the nodes of every level up to the root. All nodes are full except the last one of each slice, so the tree
+ * is shallow and queries visit few nodes. Features are identified by their position in the input, and
+ * empty boxes are never reported.
+ */
+class FeatureIndex
+{
+public:
+  FeatureIndex() = default;
+  explicit FeatureIndex(std::vector<BoundingBox> boxes);
+
+  int Size() const noexcept { return (int)m_Boxes.size(); }
+  const BoundingBox &Box(int feature) const noexcept { return m_Boxes[feature]; }
+
+  /**
+   * Finds the features whose box intersects a view.
+   * @param result Receives the features in ascending order, so drawing them keeps the input order.
+   */
+  void Query(const BoundingBox &view, std::vector<int> &result) const;
+
+private:
+  static constexpr int kNodeSize = 16;
+
+  struct Node
+  {
+    BoundingBox box;
+    int first; /**< The first child node, or the first entry in m_Entries for a leaf. */
+    int count; /**< The number of children or entries. */
+  };
+
+  std::vector<BoundingBox> m_Boxes; /**< The box of every feature. */
+  std::vector<int> m_Entries;       /**< The non-empty features in leaf order. */
+  std::vector<Node> m_Nodes;        /**< All nodes, level by level from the leaves up; the root is the last one. */
+  int m_LeafCount = 0;              /**< The nodes below this index are leaves. */
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "geometry_levels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    /**
+     * Distance of a point from the line segment a-b, or from a if the segment has no length.
+     */
+    double SegmentDistance(const Model::Node &p, const Model::Node &a, const Model::Node &b)
+    {
+        const double dx = b.x - a.x, dy = b.y - a.y;
+        const double length_sq = dx * dx + dy * dy;
+        double t = length_sq > 0.0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length_sq : 0.0;
+        t = std::clamp(t, 0.0, 1.0);
+        return std::hypot(p.x - (a.x + t * dx), p.y - (a.y + t * dy));
+    }
+
+    /**
+     * Runs Douglas-Peucker with a tolerance of zero and records for every vertex the largest tolerance at
+     * which it is still kept. A vertex is only reached once its ancestor splits are kept, so its value is
+     * capped by theirs; keeping every vertex whose value exceeds a tolerance then gives exactly the result
+     * of a Douglas-Peucker run with that tolerance. The end points get infinity.
+     *
+     * @param count The number of vertices.
+     * @param point Returns the vertex at an index.
+     */
+    template <typename PointAt>
+    std::vector<double> Significance(int count, PointAt &&point)
+    {
+        std::vector<double> significance(count, 0.0);
+        if (count == 0)
+            return significance;
+        significance.front() = significance.back() = std::numeric_limits<double>::infinity();
+
+        struct Range
+        {
+            int first, last;
+            double cap;
+        };
+        std::vector<Range> stack{{0, count - 1, std::numeric_limits<double>::infinity()}};
+        while (!stack.empty())
+        {
+            Range range = stack.back();
+            stack.pop_back();
+            if (range.last - range.first < 2)
+                continue;
+            int split = -1;
+            double farthest = -1.0;
+            for (int i = range.first + 1; i < range.last; ++i)
+            {
+                double distance = SegmentDistance(point(i), point(range.first), point(range.last));
+                if (distance > farthest)
+                {
+                    farthest = distance;
+                    split = i;
+                }
+            }
+            significance[split] = std::min(farthest, range.cap);
+            stack.push_back({range.first, split, significance[split]});
+            stack.push_back({split, range.last, significance[split]});
+        }
+        return significance;
+    }
+}
+
+/**
+ * @brief Simplifies a polyline with the Douglas-Peucker algorithm.
+ *
+ * @param points The vertices of the polyline.
+ * @param tolerance The largest allowed distance of a removed vertex from the simplified line.
+ * @return The indices of the kept vertices.
+ */
+std::vector<int> SimplifyPolyline(const std::vector<Model::Node> &points, double tolerance)
+{
+    auto significance = Significance((int)points.size(), [&](int i) -> const Model::Node &
+                                     { return points[i]; });
+    std::vector<int> kept;
+    for (int i = 0; i < (int)points.size(); ++i)
+        if (significance[i] > tolerance)
+            kept.push_back(i);
+    return kept;
+}
+
+/**
+ * @brief Simplifies every way of a model for all levels.
+ *
+ * @param model The model; it has to outlive the levels, as level 0 refers to its ways.
+ */
+GeometryLevels::GeometryLevels(const Model &model) : m_Model(&model)
+{
+    const auto &nodes = model.Nodes();
+    const auto &ways = model.Ways();
+    for (int level = 1; level < kLevels; ++level)
+        m_Offsets[level].assign(1, 0);
+
+    for (const Model::Way &way : ways)
+    {
+        auto significance = Significance((int)way.nodes.size(), [&](int i) -> const Model::Node &
+                                         { return nodes[way.nodes[i]]; });
+        for (int level = 1; level < kLevels; ++level)
+        {
+            const double tolerance = Tolerance(level);
+            for (std::size_t i = 0; i < way.nodes.size(); ++i)
+                if (significance[i] > tolerance)
+                    m_Nodes[level].push_back(way.nodes[i]);
+            m_Offsets[level].push_back((int)m_Nodes[level].size());
+        }
+    }
+}
+
+/**
+ * @brief Gives the tolerance of a level.
+ *
+ * @param level The level.
+ * @return The tolerance in map units.
+ */
+double GeometryLevels::Tolerance(int level) noexcept
+{
+    return level <= 0 ? 0.0 : kFinestTolerance * std::pow(4.0, level - 1);
+}
+
+/**
+ * @brief Picks the level to draw with for a tolerance.
+ *
+ * @param tolerance The allowed deviation in map units, e.g. half a pixel.
+ * @return The coarsest level that is at least as accurate, 0 for the original geometry.
+ */
+int GeometryLevels::LevelFor(double tolerance) noexcept
+{
+    int level = 0;
+    while (level + 1 < kLevels && Tolerance(level + 1) <= tolerance)
+        ++level;
+    return level;
+}
+
+/**
+ * @brief Looks up the nodes of a way at a level.
+ *
+ * @param way The index of the way in Model::Ways().
+ * @param level The level.
+ * @return The node indices of the simplified way.
+ */
+GeometryLevels::NodeSpan GeometryLevels::WayNodes(int way, int level) const noexcept
+{
+    if (level <= 0)
+    {
+        const auto &nodes = m_Model->Ways()[way].nodes;
+        return NodeSpan{nodes.data(), nodes.data() + nodes.size()};
+    }
+    const int *base = m_Nodes[level].data();
+    return NodeSpan{base + m_Offsets[level][way], base + m_Offsets[level][way + 1]};
+}
+
+/**
+ * @brief Counts the vertices of all ways at a level.
+ *
+ * @param level The level.
+ * @return The number of stored node indices.
+ */
+std::size_t GeometryLevels::VertexCount(int level) const noexcept
+{
+    if (level > 0)
+        return m_Nodes[level].size();
+    std::size_t count = 0;
+    for (const auto &way : m_Model->Ways())
+        count += way.nodes.size();
+    return count;
+}
@@ -0,0 +1,70 @@
+#ifndef GEOMETRY_LEVELS_H
+#define GEOMETRY_LEVELS_H
+
+#include <vector>
+#include "model.h"
+
+/**
+ * Douglas-Peucker simplification of a polyline.
+ * @param tolerance The largest distance in map units a removed vertex may have from the simplified line.
+ * @return The indices into `points` of the vertices that are kept, in order and always including both ends.
+ *         A closed polyline is measured against its first vertex, so it does not collapse at once.
+ */
+std::vector<int> SimplifyPolyline(const std::vector<Model::Node> &points, double tolerance);
+
+/**
+ * @class GeometryLevels
+ * @brief Precomputed simplified node lists of every way for a ladder of tolerances.
+ *
+ * Level 0 is the original geometry, and every following level quadruples the tolerance of the one
+ * before, starting at kFinestTolerance. A single Douglas-Peucker pass per way records for every vertex the
+ * largest tolerance at which it is still kept, so building all levels costs about as much as simplifying once.
+ * The levels are stored like the CSR arrays of RoadGraph: one offset array and one node array per level.
+ */
+class GeometryLevels
+{
+public:
+  static constexpr int kLevels = 7;                 /**< Including the original geometry at level 0. */
+  static constexpr double kFinestTolerance = 1e-5; /**< The tolerance of level 1 in map units. */
+
+  /**
+   * A view of the node indices of one way at one level.
+   */
+  struct NodeSpan
+  {
+    const int *first = nullptr;
+    const int *last = nullptr;
+
+    const int *begin() const noexcept { return first; }
+    const int *end() const noexcept { return last; }
+    std::size_t size() const noexcept { return (std::size_t)(last - first); }
+    bool empty() const noexcept { return first == last; }
+  };
+
+  GeometryLevels() = default;
+  explicit GeometryLevels(const Model &model);
+
+  /**
+   * The tolerance of a level in map units; 0 for level 0.
+   */
+  static double Tolerance(int level) noexcept;
+
+  /**
+   * The coarsest level whose tolerance does not exceed the given one.
+   */
+  static int LevelFor(double tolerance) noexcept;
+
+  NodeSpan WayNodes(int way, int level) const noexcept;
+
+  /**
+   * The number of way vertices stored for a level, summed over all ways.
+   */
+  std::size_t VertexCount(int level) const noexcept;
+
+private:
+  const Model *m_Model = nullptr;
+  std::vector<int> m_Offsets[kLevels]; /**< Per level from 1: the first node of every way, plus one past-the-end entry. */
+  std::vector<int> m_Nodes[kLevels];   /**< Per level from 1: the kept nodes of all ways, grouped by way. */
+};
+
+#endif
@@ -0,0 +1,382 @@
+#include "graph_search.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+/**
+ * @brief Starts a new search.
+ *
+ * Grows the per-node arrays if the graph is larger than the previous one and bumps the generation, which
+ * invalidates every distance, parent and mark of the previous search without touching them.
+ *
+ * @param node_count The number of nodes in the graph that is going to be searched.
+ */
+void SearchWorkspace::Reset(int node_count)
+{
+    if ((int)m_Reached.size() < node_count)
+    {
+        m_Reached.resize(node_count, 0);
+        m_Settled.resize(node_count, 0);
+        m_Marked.resize(node_count, 0);
+        m_Distance.resize(node_count);
+        m_Parent.resize(node_count);
+    }
+    if (++m_Generation == 0)
+    {
+        // The counter wrapped around, so old tags could look current again.
+        std::fill(m_Reached.begin(), m_Reached.end(), 0);
+        std::fill(m_Settled.begin(), m_Settled.end(), 0);
+        std::fill(m_Marked.begin(), m_Marked.end(), 0);
+        m_Generation = 1;
+    }
+    m_Queue.clear();
+    m_MonotoneQueue.Clear();
+}
+
+/**
+ * Lowers the tentative distance of a node without adding it to a queue.
+ *
+ * @param node The node to update.
+ * @param distance The new tentative distance from the source.
+ * @param parent The node the new distance was reached from.
+ * @return True if the distance improved.
+ */
+bool SearchWorkspace::Update(int node, float distance, int parent)
+{
+    if (distance >= Distance(node))
+        return false;
+    m_Reached[node] = m_Generation;
+    m_Distance[node] = distance;
+    m_Parent[node] = parent;
+    return true;
+}
+
+/**
+ * Lowers the tentative distance of a node and queues it.
+ *
+ * @param node The node to update.
+ * @param distance The new tentative distance from the source.
+ * @param parent The node the new distance was reached from.
+ * @param priority The queue key, i.e. the distance plus the heuristic for goal-directed searches.
+ * @return True if the distance improved and the node was queued.
+ */
+bool SearchWorkspace::Relax(int node, float distance, int parent, float priority)
+{
+    if (!Update(node, distance, parent))
+        return false;
+    m_Queue.emplace_back(priority, node);
+    std::push_heap(m_Queue.begin(), m_Queue.end(), std::greater<>{});
+    return true;
+}
+
+/**
+ * Removes the entry with the lowest priority from the queue.
+ * Entries of settled nodes are left in the queue when a node is improved, so callers skip settled nodes.
+ *
+ * @return The priority and node index of the removed entry.
+ */
+std::pair<float, int> SearchWorkspace::PopQueue()
+{
+    std::pop_heap(m_Queue.begin(), m_Queue.end(), std::greater<>{});
+    auto top = m_Queue.back();
+    m_Queue.pop_back();
+    return top;
+}
+
+/**
+ * @brief Computes the distances from one source to a set of targets.
+ *
+ * This is a plain Dijkstra search that stops as soon as the last distinct target has been settled,
+ * so only the part of the graph that is closer than the farthest target is explored.
+ *
+ * @param graph The graph to search.
+ * @param source The index of the start node.
+ * @param targets The indices of the target nodes.
+ * @param workspace The scratch memory of the calling thread.
+ * @param distances Receives one distance per target, infinity if the target is not reachable.
+ */
+void DistancesToTargets(const RoadGraph &graph, int source, const std::vector<int> &targets,
+                        SearchWorkspace &workspace, float *distances)
+{
+    workspace.Reset(graph.NodeCount());
+
+    int remaining = 0;
+    for (int target : targets)
+        if (target >= 0 && !workspace.IsMarked(target))
+        {
+            workspace.Mark(target);
+            ++remaining;
+        }
+
+    RadixHeap &queue = workspace.MonotoneQueue();
+    if (source >= 0)
+    {
+        workspace.Update(source, 0.f, -1);
+        queue.Push(0.f, source);
+    }
+
+    while (remaining > 0 && !queue.Empty())
+    {
+        auto [distance, node] = queue.Pop();
+        if (workspace.IsSettled(node))
+            continue;
+        workspace.Settle(node);
+        if (workspace.IsMarked(node))
+            --remaining;
+
+        for (auto edge = graph.EdgesBegin(node); edge != graph.EdgesEnd(node); ++edge)
+            if (!workspace.IsSettled(edge->to) && workspace.Update(edge->to, distance + edge->length, node))
+                queue.Push(distance + edge->length, edge->to);
+    }
+
+    for (size_t i = 0; i < targets.size(); ++i)
+        distances[i] = targets[i] >= 0 && workspace.IsSettled(targets[i]) ? workspace.Distance(targets[i])
+                                                                         : SearchWorkspace::kInfinity;
+}
+
+/**
+ * @brief Computes the shortest path tree of all nodes within a distance bound.
+ *
+ * Without a heuristic the queue keys never decrease, so the search uses the workspace's radix heap instead
+ * of the binary heap. Nodes beyond the bound are never settled, which keeps the tree compact.
+ *
+ * @param graph The graph to search.
+ * @param source The index of the start node.
+ * @param max_distance The distance bound in normalized map units.
+ * @param workspace The scratch memory of the calling thread.
+ * @param tree Receives the settled nodes in settle order together with their distances.
+ */
+void SettleWithinDistance(const RoadGraph &graph, int source, float max_distance,
+                          SearchWorkspace &workspace, ShortestPathTree &tree)
+{
+    workspace.Reset(graph.NodeCount());
+    tree.source = source;
+    tree.nodes.clear();
+    tree.distances.clear();
+    if (source < 0)
+        return;
+
+    RadixHeap &queue = workspace.MonotoneQueue();
+    workspace.Update(source, 0.f, -1);
+    queue.Push(0.f, source);
+
+    while (!queue.Empty())
+    {
+        auto [distance, node] = queue.Pop();
+        if (distance > max_distance)
+            break;
+        if (workspace.IsSettled(node))
+            continue;
+        workspace.Settle(node);
+        tree.nodes.push_back(node);
+        tree.distances.push_back(distance);
+
+        for (auto edge = graph.EdgesBegin(node); edge != graph.EdgesEnd(node); ++edge)
+            if (!workspace.IsSettled(edge->to) && workspace.Update(edge->to, distance + edge->length, node))
+                queue.Push(distance + edge->length, edge->to);
+    }
+}
+
+/**
+ * Appends the interior nodes of a chain from one position to another, both inclusive, stepping towards the
+ * second position.
+ *
+ * @param graph The graph.
+ * @param first The chain side table position to start at.
+ * @param last The chain side table position to stop at.
+ * @param nodes The node list to append to.
+ */
+static void AppendChainRun(const RoadGraph &graph, int first, int last, std::vector<int> &nodes)
+{
+    const int step = first <= last ? 1 : -1;
+    for (int position = first; position != last + step; position += step)
+        nodes.push_back(graph.ChainNode(position));
+}
+
+/**
+ * @brief Finds the shortest path between two nodes.
+ *
+ * Nodes in different components are rejected right away with RouteStatus::Disconnected. The search runs on the
+ * compressed view of the graph, so it only visits core nodes and steps over whole chains of degree-2 nodes at
+ * once. An interior start node enters the search at the two ends of its chain with their distances along the
+ * chain; an interior end node is reached from the two ends of its chain, or directly if both nodes lie on the
+ * same chain. The straight-line distance to the target never overestimates the road distance, so the search
+ * stops once the smallest queue key reaches the best distance found. The core path is then read back through
+ * the chains stored as parents in the workspace, unpacked to every node, and the distances are summed edge by
+ * edge from the start, which gives exactly the values a search over the uncompressed graph would.
+ *
+ * @param graph The graph to search.
+ * @param source The index of the start node.
+ * @param target The index of the end node.
+ * @param workspace The scratch memory of the calling thread.
+ * @param path Receives the path from source to target with cumulative distances in meters.
+ * @param trace If not null, receives the core nodes in settle order and the core nodes left in the queue.
+ * @param cancel If not null, checked before every settled node, so a stale query stops within one step.
+ * @return True if a path was found.
+ */
+bool FindShortestPath(const RoadGraph &graph, int source, int target, SearchWorkspace &workspace, RoutePath &path,
+                      SearchTrace *trace, const std::atomic<bool> *cancel)
+{
+    path.nodes.clear();
+    path.distances.clear();
+    path.status = RouteStatus::NoRoute;
+    if (trace)
+        trace->Clear();
+    if (source < 0 || target < 0)
+        return false;
+    if (source == target)
+    {
+        path.nodes.push_back(source);
+        path.distances.push_back(0.f);
+        path.status = RouteStatus::Found;
+        return true;
+    }
+    if (!graph.IsRoutable(source) || !graph.IsRoutable(target))
+        return false;
+    if (!graph.Connected(source, target))
+    {
+        path.status = RouteStatus::Disconnected;
+        return false;
+    }
+
+    workspace.Reset(graph.NodeCount());
+    const int source_chain = graph.IsCore(source) ? -1 : graph.ChainOf(source);
+    const int target_chain = graph.IsCore(target) ? -1 : graph.ChainOf(target);
+
+    // Seed the search; seeds have no parent chain.
+    if (source_chain < 0)
+        workspace.Relax(source, 0.f, -1, graph.Distance(source, target));
+    else
+    {
+        const auto &chain = graph.GetChain(source_chain);
+        float to_from = graph.ChainOffset(source);
+        float to_to = chain.length - to_from;
+        workspace.Relax(chain.from, to_from, -1, to_from + graph.Distance(chain.from, target));
+        workspace.Relax(chain.to, to_to, -1, to_to + graph.Distance(chain.to, target));
+    }
+    if (trace)
+        for (int seed : {source_chain < 0 ? source : graph.GetChain(source_chain).from,
+                         source_chain < 0 ? source : graph.GetChain(source_chain).to})
+            if (!workspace.IsMarked(seed))
+            {
+                workspace.Mark(seed);
+                trace->frontier.push_back(seed);
+            }
+
+    // The best complete distance so far and the core node it leaves the core graph at, -1 for the direct
+    // run along a shared chain.
+    float best = SearchWorkspace::kInfinity;
+    int exit_node = -2;
+    if (source_chain >= 0 && source_chain == target_chain)
+    {
+        best = std::abs(graph.ChainOffset(target) - graph.ChainOffset(source));
+        exit_node = -1;
+    }
+
+    while (!workspace.QueueEmpty())
+    {
+        auto [priority, node] = workspace.PopQueue();
+        if (priority >= best)
+            break;
+        if (workspace.IsSettled(node))
+            continue;
+        if (cancel && cancel->load(std::memory_order_relaxed))
+        {
+            path.status = RouteStatus::Cancelled;
+            return false;
+        }
+        workspace.Settle(node);
+        if (trace)
+            trace->settled.push_back(node);
+
+        float distance = workspace.Distance(node);
+        if (node == target)
+        {
+            best = distance;
+            exit_node = node;
+            break;
+        }
+        if (target_chain >= 0)
+        {
+            const auto &chain = graph.GetChain(target_chain);
+            float via_from = node == chain.from ? distance + graph.ChainOffset(target) : SearchWorkspace::kInfinity;
+            float via_to = node == chain.to ? distance + chain.length - graph.ChainOffset(target) : SearchWorkspace::kInfinity;
+            if (std::min(via_from, via_to) < best)
+            {
+                best = std::min(via_from, via_to);
+                exit_node = node;
+            }
+        }
+
+        for (auto edge = graph.ChainEdgesBegin(node); edge != graph.ChainEdgesEnd(node); ++edge)
+            if (!workspace.IsSettled(edge->to))
+            {
+                float g = distance + edge->length;
+                if (workspace.Relax(edge->to, g, edge->chain, g + graph.Distance(edge->to, target)) && trace &&
+                    !workspace.IsMarked(edge->to))
+                {
+                    // The frontier is filtered once the search stops; marks keep every node in it once.
+                    workspace.Mark(edge->to);
+                    trace->frontier.push_back(edge->to);
+                }
+            }
+    }
+    if (trace)
+        trace->frontier.erase(std::remove_if(trace->frontier.begin(), trace->frontier.end(),
+                                             [&](int node) { return workspace.IsSettled(node); }),
+                              trace->frontier.end());
+    if (exit_node == -2)
+        return false;
+
+    // Collect the nodes from the target back to the source.
+    std::vector<int> &nodes = path.nodes;
+    if (exit_node == -1)
+    {
+        AppendChainRun(graph, graph.ChainPosition(target), graph.ChainPosition(source), nodes);
+    }
+    else
+    {
+        if (target_chain >= 0)
+        {
+            // Walk from the target to the end of its chain the search left the core graph at.
+            const auto &chain = graph.GetChain(target_chain);
+            bool via_from = exit_node == chain.from &&
+                            (exit_node != chain.to || graph.ChainOffset(target) <= chain.length - graph.ChainOffset(target));
+            int end = via_from ? graph.ChainBegin(target_chain) : graph.ChainEnd(target_chain) - 1;
+            AppendChainRun(graph, graph.ChainPosition(target), end, nodes);
+        }
+        int node = exit_node;
+        nodes.push_back(node);
+        for (int chain_index = workspace.Parent(node); chain_index >= 0; chain_index = workspace.Parent(node))
+        {
+            const auto &chain = graph.GetChain(chain_index);
+            bool from_end = node == chain.to;
+            if (graph.ChainBegin(chain_index) != graph.ChainEnd(chain_index))
+                AppendChainRun(graph, from_end ? graph.ChainEnd(chain_index) - 1 : graph.ChainBegin(chain_index),
+                               from_end ? graph.ChainBegin(chain_index) : graph.ChainEnd(chain_index) - 1, nodes);
+            node = from_end ? chain.from : chain.to;
+            nodes.push_back(node);
+        }
+        if (source_chain >= 0)
+        {
+            // The seed the path starts at is an end of the source's chain; walk on to the source.
+            const auto &chain = graph.GetChain(source_chain);
+            bool via_from = node == chain.from &&
+                            (node != chain.to || graph.ChainOffset(source) <= chain.length - graph.ChainOffset(source));
+            int begin = via_from ? graph.ChainBegin(source_chain) : graph.ChainEnd(source_chain) - 1;
+            AppendChainRun(graph, begin, graph.ChainPosition(source), nodes);
+        }
+    }
+    std::reverse(nodes.begin(), nodes.end());
+
+    path.distances.reserve(nodes.size());
+    float distance = 0.f;
+    path.distances.push_back(0.f);
+    for (size_t i = 1; i < nodes.size(); ++i)
+    {
+        distance += graph.Distance(nodes[i - 1], nodes[i]);
+        path.distances.push_back(distance * graph.MetricScale());
+    }
+    path.status = RouteStatus::Found;
+    return true;
+}
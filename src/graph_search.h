@@ -0,0 +1,127 @@
+#ifndef GRAPH_SEARCH_H
+#define GRAPH_SEARCH_H
+
+#include <atomic>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "radix_heap.h"
+#include "road_graph.h"
+#include "route_path.h"
+
+/**
+ * @class SearchWorkspace
+ * @brief Per-thread scratch memory for searches on a RoadGraph.
+ *
+ * The workspace keeps tentative distances, parents and the priority queue outside of the graph, so that
+ * several searches can run on the same graph at the same time as long as each one uses its own workspace.
+ * Entries are tagged with a generation number, which makes starting a new search O(1) instead of O(nodes).
+ */
+class SearchWorkspace
+{
+public:
+  static constexpr float kInfinity = std::numeric_limits<float>::infinity();
+
+  /**
+   * Starts a new search over a graph with the given number of nodes.
+   */
+  void Reset(int node_count);
+
+  float Distance(int node) const noexcept { return m_Reached[node] == m_Generation ? m_Distance[node] : kInfinity; }
+  int Parent(int node) const noexcept { return m_Reached[node] == m_Generation ? m_Parent[node] : -1; }
+  bool IsSettled(int node) const noexcept { return m_Settled[node] == m_Generation; }
+  void Settle(int node) noexcept { m_Settled[node] = m_Generation; }
+
+  bool IsMarked(int node) const noexcept { return m_Marked[node] == m_Generation; }
+  void Mark(int node) noexcept { m_Marked[node] = m_Generation; }
+
+  /**
+   * Lowers the tentative distance of a node without queueing it.
+   * @return True if the distance was improved.
+   */
+  bool Update(int node, float distance, int parent);
+
+  /**
+   * Lowers the tentative distance of a node and queues it with the given priority.
+   * @return True if the distance was improved.
+   */
+  bool Relax(int node, float distance, int parent, float priority);
+
+  bool QueueEmpty() const noexcept { return m_Queue.empty(); }
+
+  /**
+   * Removes the queue entry with the lowest priority.
+   * @return The priority and the node of the entry.
+   */
+  std::pair<float, int> PopQueue();
+
+  /**
+   * Queue for searches whose keys never decrease, i.e. Dijkstra without a heuristic.
+   */
+  RadixHeap &MonotoneQueue() noexcept { return m_MonotoneQueue; }
+
+private:
+  unsigned m_Generation = 0;
+  std::vector<unsigned> m_Reached; /**< Generation in which the node got a tentative distance. */
+  std::vector<unsigned> m_Settled; /**< Generation in which the node was settled. */
+  std::vector<unsigned> m_Marked;  /**< Generation in which the node was marked by the caller. */
+  std::vector<float> m_Distance;
+  std::vector<int> m_Parent;
+  std::vector<std::pair<float, int>> m_Queue; /**< Binary min-heap with lazy deletion. */
+  RadixHeap m_MonotoneQueue;
+};
+
+/**
+ * @brief Result of a one-to-all search: every settled node with its distance from the source.
+ *
+ * The nodes are stored in the order they were settled, so distances are non-decreasing.
+ */
+struct ShortestPathTree
+{
+  int source = -1;              /**< The node the search started from. */
+  std::vector<int> nodes;       /**< The settled nodes. */
+  std::vector<float> distances; /**< The distance of each settled node from the source. */
+};
+
+/**
+ * Runs Dijkstra's algorithm from source until every node in targets is settled or nothing else is reachable.
+ *
+ * @param graph The graph to search.
+ * @param source The index of the start node.
+ * @param targets The indices of the nodes whose distances are wanted. Duplicates are allowed.
+ * @param workspace The scratch memory of the calling thread.
+ * @param distances Receives targets.size() distances in normalized map units, infinity for unreachable targets.
+ */
+void DistancesToTargets(const RoadGraph &graph, int source, const std::vector<int> &targets,
+                        SearchWorkspace &workspace, float *distances);
+
+/**
+ * Runs Dijkstra's algorithm from source and settles every node within max_distance.
+ *
+ * @param graph The graph to search.
+ * @param source The index of the start node.
+ * @param max_distance The distance bound in normalized map units, infinity for no bound.
+ * @param workspace The scratch memory of the calling thread.
+ * @param tree Receives the settled nodes and their distances in normalized map units.
+ */
+void SettleWithinDistance(const RoadGraph &graph, int source, float max_distance,
+                          SearchWorkspace &workspace, ShortestPathTree &tree);
+
+/**
+ * Runs an A* search from source to target using the straight-line distance as the heuristic.
+ *
+ * @param graph The graph to search.
+ * @param source The index of the start node.
+ * @param target The index of the end node.
+ * @param workspace The scratch memory of the calling thread.
+ * @param path Receives the nodes of the shortest path and their distances in meters; cleared if there is none,
+ *             with the status telling why.
+ * @param trace If not null, receives the settled and frontier nodes of the search.
+ * @param cancel If not null, polled during the search; once it is set the search stops with
+ *               RouteStatus::Cancelled.
+ * @return True if the target is reachable.
+ */
+bool FindShortestPath(const RoadGraph &graph, int source, int target, SearchWorkspace &workspace, RoutePath &path,
+                      SearchTrace *trace = nullptr, const std::atomic<bool> *cancel = nullptr);
+
+#endif
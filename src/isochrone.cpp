@@ -0,0 +1,217 @@
+#include "isochrone.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+/**
+ * @brief Finds every routable node within a road distance of a depot.
+ *
+ * Snaps the depot to the closest routable node and runs a bounded one-to-all search from there.
+ *
+ * @param model The route model to search.
+ * @param depot The depot coordinates in percent.
+ * @param max_distance The distance bound in meters.
+ * @return The settled nodes with their distances in meters.
+ */
+ShortestPathTree ComputeReachableNodes(const RouteModel &model, MapCoordinate depot, float max_distance)
+{
+    const RoadGraph &graph = model.Graph();
+    const auto scale = (float)model.MetricScale();
+
+    SearchWorkspace workspace;
+    ShortestPathTree tree;
+    int source = graph.FindClosestNode(depot.x * 0.01f, depot.y * 0.01f);
+    SettleWithinDistance(graph, source, max_distance / scale, workspace, tree);
+    for (auto &distance : tree.distances)
+        distance *= scale;
+    return tree;
+}
+
+namespace
+{
+    /**
+     * Distance field sampled on the vertices of a regular grid, with a border of unreached vertices
+     * so that every contour is closed.
+     */
+    struct DistanceGrid
+    {
+        float origin_x = 0.f;
+        float origin_y = 0.f;
+        float cell = 1.f;
+        int cols = 0; /**< Number of cells along x; there are cols + 1 vertices per row. */
+        int rows = 0; /**< Number of cells along y. */
+        std::vector<float> values;
+
+        float &At(int i, int j) { return values[j * (cols + 1) + i]; }
+        float At(int i, int j) const { return values[j * (cols + 1) + i]; }
+    };
+
+    /**
+     * Identifies the grid edge crossed by a contour, shared by the two cells on either side of it.
+     */
+    int HorizontalEdge(const DistanceGrid &grid, int i, int j) { return 2 * (j * (grid.cols + 1) + i); }
+    int VerticalEdge(const DistanceGrid &grid, int i, int j) { return 2 * (j * (grid.cols + 1) + i) + 1; }
+}
+
+/**
+ * Samples the distances of a tree on a grid.
+ *
+ * @param model The route model the tree was computed on.
+ * @param tree The settled nodes and their distances in meters.
+ * @param resolution The number of cells along the longer side of the reached area.
+ * @return The sampled distance grid.
+ */
+static DistanceGrid SampleDistances(const RouteModel &model, const ShortestPathTree &tree, int resolution)
+{
+    const RoadGraph &graph = model.Graph();
+    const auto scale = (float)model.MetricScale();
+
+    float min_x = std::numeric_limits<float>::max(), min_y = min_x;
+    float max_x = std::numeric_limits<float>::lowest(), max_y = max_x;
+    for (int node : tree.nodes)
+    {
+        const auto &p = graph.Position(node);
+        min_x = std::min(min_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_x = std::max(max_x, p.x);
+        max_y = std::max(max_y, p.y);
+    }
+
+    DistanceGrid grid;
+    grid.cell = std::max(std::max(max_x - min_x, max_y - min_y) / std::max(resolution, 1), 1e-5f);
+    // Two cells of margin on every side: a node on the edge of the reached area can round into the next cell,
+    // and the outermost ring of vertices has to stay unreached for the contours to close.
+    grid.origin_x = min_x - 2.f * grid.cell;
+    grid.origin_y = min_y - 2.f * grid.cell;
+    grid.cols = (int)std::floor((max_x - min_x) / grid.cell) + 5;
+    grid.rows = (int)std::floor((max_y - min_y) / grid.cell) + 5;
+    grid.values.assign((grid.cols + 1) * (grid.rows + 1), SearchWorkspace::kInfinity);
+
+    for (size_t k = 0; k < tree.nodes.size(); ++k)
+    {
+        const auto &p = graph.Position(tree.nodes[k]);
+        int ci = (int)std::floor((p.x - grid.origin_x) / grid.cell);
+        int cj = (int)std::floor((p.y - grid.origin_y) / grid.cell);
+        for (int j = cj; j <= cj + 1; ++j)
+            for (int i = ci; i <= ci + 1; ++i)
+            {
+                float vx = grid.origin_x + i * grid.cell;
+                float vy = grid.origin_y + j * grid.cell;
+                float d = tree.distances[k] + std::hypot(p.x - vx, p.y - vy) * scale;
+                grid.At(i, j) = std::min(grid.At(i, j), d);
+            }
+    }
+    return grid;
+}
+
+/**
+ * Traces the contour of one distance level with marching squares.
+ *
+ * @param grid The sampled distances.
+ * @param level The distance of the contour in meters.
+ * @return The closed contour rings, each ending with its first point.
+ */
+static std::vector<std::vector<RoadGraph::Point>> TraceContours(const DistanceGrid &grid, float level)
+{
+    // For every cell case, the pairs of cell edges (bottom, right, top, left) the contour crosses.
+    static const std::array<std::vector<std::array<int, 2>>, 16> kSegments{{
+        {}, {{3, 0}}, {{0, 1}}, {{3, 1}}, {{1, 2}}, {{3, 0}, {1, 2}}, {{0, 2}}, {{3, 2}},
+        {{2, 3}}, {{0, 2}}, {{0, 1}, {2, 3}}, {{1, 2}}, {{1, 3}}, {{0, 1}}, {{3, 0}}, {}}};
+
+    auto inside = [&](int i, int j)
+    { return grid.At(i, j) <= level; };
+
+    // The point where the contour crosses the edge between two vertices.
+    auto crossing = [&](int i0, int j0, int i1, int j1)
+    {
+        float a = grid.At(i0, j0), b = grid.At(i1, j1);
+        float t = 0.5f;
+        if (std::isfinite(a) && std::isfinite(b) && a != b)
+            t = std::clamp((level - a) / (b - a), 0.f, 1.f);
+        return RoadGraph::Point{grid.origin_x + (i0 + t * (i1 - i0)) * grid.cell,
+                                grid.origin_y + (j0 + t * (j1 - j0)) * grid.cell};
+    };
+
+    std::vector<std::array<int, 2>> segments;
+    std::unordered_map<int, RoadGraph::Point> points;
+    std::unordered_map<int, std::array<int, 2>> edge_segments;
+
+    for (int j = 0; j < grid.rows; ++j)
+        for (int i = 0; i < grid.cols; ++i)
+        {
+            int cell_case = inside(i, j) | inside(i + 1, j) << 1 | inside(i + 1, j + 1) << 2 | inside(i, j + 1) << 3;
+            if (kSegments[cell_case].empty())
+                continue;
+
+            const std::array<int, 4> edges{HorizontalEdge(grid, i, j), VerticalEdge(grid, i + 1, j),
+                                           HorizontalEdge(grid, i, j + 1), VerticalEdge(grid, i, j)};
+            points.try_emplace(edges[0], crossing(i, j, i + 1, j));
+            points.try_emplace(edges[1], crossing(i + 1, j, i + 1, j + 1));
+            points.try_emplace(edges[2], crossing(i, j + 1, i + 1, j + 1));
+            points.try_emplace(edges[3], crossing(i, j, i, j + 1));
+
+            for (auto [from, to] : kSegments[cell_case])
+            {
+                int segment = (int)segments.size();
+                segments.push_back({edges[from], edges[to]});
+                for (int edge : {edges[from], edges[to]})
+                {
+                    auto it = edge_segments.try_emplace(edge, std::array<int, 2>{-1, -1}).first;
+                    it->second[it->second[0] < 0 ? 0 : 1] = segment;
+                }
+            }
+        }
+
+    // Every crossed edge is shared by exactly two segments, so following them always closes a ring.
+    std::vector<std::vector<RoadGraph::Point>> rings;
+    std::vector<bool> used(segments.size(), false);
+    for (size_t first = 0; first < segments.size(); ++first)
+    {
+        if (used[first])
+            continue;
+        std::vector<RoadGraph::Point> ring;
+        int segment = (int)first;
+        int edge = segments[first][0];
+        while (segment >= 0 && !used[segment])
+        {
+            used[segment] = true;
+            ring.push_back(points[edge]);
+            edge = segments[segment][0] == edge ? segments[segment][1] : segments[segment][0];
+            const auto &pair = edge_segments[edge];
+            segment = pair[0] == segment ? pair[1] : pair[0];
+        }
+        // Repeat the first point once the walk is back at its starting edge, so the ring is explicitly closed.
+        if (edge == segments[first][0])
+            ring.push_back(ring.front());
+        rings.push_back(std::move(ring));
+    }
+    return rings;
+}
+
+/**
+ * @brief Turns a shortest path tree into isochrone contours.
+ *
+ * @param model The route model the tree was computed on.
+ * @param tree The result of ComputeReachableNodes.
+ * @param levels The distances in meters to draw a contour for.
+ * @param resolution The number of grid cells along the longer side of the reached area.
+ * @return One Isochrone per level, in the order of levels.
+ */
+std::vector<Isochrone> ComputeIsochrones(const RouteModel &model, const ShortestPathTree &tree,
+                                         const std::vector<float> &levels, int resolution)
+{
+    std::vector<Isochrone> isochrones;
+    if (tree.nodes.empty())
+    {
+        for (float level : levels)
+            isochrones.push_back(Isochrone{level, {}});
+        return isochrones;
+    }
+
+    const DistanceGrid grid = SampleDistances(model, tree, resolution);
+    for (float level : levels)
+        isochrones.push_back(Isochrone{level, TraceContours(grid, level)});
+    return isochrones;
+}
@@ -0,0 +1,46 @@
+#ifndef ISOCHRONE_H
+#define ISOCHRONE_H
+
+#include <vector>
+#include "graph_search.h"
+#include "route_model.h"
+
+/**
+ * @brief Boundary of the area reachable within a distance.
+ *
+ * Each contour is a closed ring of points in the normalized map coordinates used by Model::Nodes(),
+ * so it can be drawn with the same transform as the map. The last point of a ring repeats its first.
+ */
+struct Isochrone
+{
+  float distance = 0.f;                                  /**< The distance bound of the contour in meters. */
+  std::vector<std::vector<RoadGraph::Point>> contours;   /**< The closed rings enclosing the reachable area. */
+};
+
+/**
+ * Finds every routable node within a road distance of a depot.
+ *
+ * @param model The route model to search.
+ * @param depot The depot coordinates in percent, as accepted by RoutePlanner.
+ * @param max_distance The distance bound in meters.
+ * @return The settled nodes in settle order with their distances in meters.
+ */
+ShortestPathTree ComputeReachableNodes(const RouteModel &model, MapCoordinate depot, float max_distance);
+
+/**
+ * Turns a shortest path tree into isochrone contours.
+ *
+ * The distances are sampled on a square grid over the reached nodes; every grid vertex takes the smallest
+ * distance of a node in an adjacent cell plus the straight-line distance to that node, and the contours are
+ * traced with marching squares.
+ *
+ * @param model The route model the tree was computed on.
+ * @param tree The result of ComputeReachableNodes.
+ * @param levels The distances in meters to draw a contour for.
+ * @param resolution The number of grid cells along the longer side of the reached area.
+ * @return One Isochrone per level.
+ */
+std::vector<Isochrone> ComputeIsochrones(const RouteModel &model, const ShortestPathTree &tree,
+                                         const std::vector<float> &levels, int resolution = 64);
+
+#endif
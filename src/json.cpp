@@ -0,0 +1,365 @@
+#include "json.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    /**
+     * Recursive descent parser over a string_view. Every Parse* method leaves the position after the
+     * parsed element and returns false on malformed input.
+     */
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(std::string_view text) : m_Text(text) {}
+
+        bool ParseDocument(JsonValue &value)
+        {
+            return ParseValue(value, 0) && (SkipSpace(), m_Pos == m_Text.size());
+        }
+
+    private:
+        static constexpr int kMaxDepth = 64;
+
+        void SkipSpace()
+        {
+            while (m_Pos < m_Text.size() && std::isspace((unsigned char)m_Text[m_Pos]))
+                ++m_Pos;
+        }
+
+        bool Consume(char c)
+        {
+            SkipSpace();
+            if (m_Pos < m_Text.size() && m_Text[m_Pos] == c)
+            {
+                ++m_Pos;
+                return true;
+            }
+            return false;
+        }
+
+        bool ConsumeWord(std::string_view word)
+        {
+            if (m_Text.substr(m_Pos, word.size()) != word)
+                return false;
+            m_Pos += word.size();
+            return true;
+        }
+
+        bool ParseValue(JsonValue &value, int depth)
+        {
+            if (depth > kMaxDepth)
+                return false;
+            SkipSpace();
+            if (m_Pos >= m_Text.size())
+                return false;
+
+            switch (m_Text[m_Pos])
+            {
+            case '{':
+                return ParseObject(value, depth);
+            case '[':
+                return ParseArray(value, depth);
+            case '"':
+                value.type = JsonValue::Type::String;
+                return ParseString(value.string);
+            case 't':
+                value.type = JsonValue::Type::Bool;
+                value.boolean = true;
+                return ConsumeWord("true");
+            case 'f':
+                value.type = JsonValue::Type::Bool;
+                value.boolean = false;
+                return ConsumeWord("false");
+            case 'n':
+                value.type = JsonValue::Type::Null;
+                return ConsumeWord("null");
+            default:
+                return ParseNumber(value);
+            }
+        }
+
+        bool ParseObject(JsonValue &value, int depth)
+        {
+            value.type = JsonValue::Type::Object;
+            ++m_Pos;
+            if (Consume('}'))
+                return true;
+            do
+            {
+                SkipSpace();
+                std::string key;
+                if (!ParseString(key) || !Consume(':'))
+                    return false;
+                JsonValue member;
+                if (!ParseValue(member, depth + 1))
+                    return false;
+                value.object.emplace_back(std::move(key), std::move(member));
+            } while (Consume(','));
+            return Consume('}');
+        }
+
+        bool ParseArray(JsonValue &value, int depth)
+        {
+            value.type = JsonValue::Type::Array;
+            ++m_Pos;
+            if (Consume(']'))
+                return true;
+            do
+            {
+                JsonValue element;
+                if (!ParseValue(element, depth + 1))
+                    return false;
+                value.array.push_back(std::move(element));
+            } while (Consume(','));
+            return Consume(']');
+        }
+
+        bool ConsumeDigits()
+        {
+            const size_t begin = m_Pos;
+            while (m_Pos < m_Text.size() && std::isdigit((unsigned char)m_Text[m_Pos]))
+                ++m_Pos;
+            return m_Pos > begin;
+        }
+
+        bool ParseNumber(JsonValue &value)
+        {
+            // Follow the JSON grammar, which is stricter than strtod: no leading '+', '.' or zeros, no "inf".
+            const size_t begin = m_Pos;
+            if (m_Pos < m_Text.size() && m_Text[m_Pos] == '-')
+                ++m_Pos;
+            if (m_Pos < m_Text.size() && m_Text[m_Pos] == '0')
+                ++m_Pos;
+            else if (!ConsumeDigits())
+                return false;
+            if (m_Pos < m_Text.size() && m_Text[m_Pos] == '.')
+            {
+                ++m_Pos;
+                if (!ConsumeDigits())
+                    return false;
+            }
+            if (m_Pos < m_Text.size() && (m_Text[m_Pos] == 'e' || m_Text[m_Pos] == 'E'))
+            {
+                ++m_Pos;
+                if (m_Pos < m_Text.size() && (m_Text[m_Pos] == '+' || m_Text[m_Pos] == '-'))
+                    ++m_Pos;
+                if (!ConsumeDigits())
+                    return false;
+            }
+            // strtod needs a terminated buffer, and numbers are short.
+            value.type = JsonValue::Type::Number;
+            value.string = std::string{m_Text.substr(begin, m_Pos - begin)};
+            value.number = std::strtod(value.string.c_str(), nullptr);
+            return std::isfinite(value.number);
+        }
+
+        bool ParseString(std::string &out)
+        {
+            if (m_Pos >= m_Text.size() || m_Text[m_Pos] != '"')
+                return false;
+            ++m_Pos;
+            while (m_Pos < m_Text.size())
+            {
+                char c = m_Text[m_Pos++];
+                if (c == '"')
+                    return true;
+                if (c != '\\')
+                {
+                    out.push_back(c);
+                    continue;
+                }
+                if (m_Pos >= m_Text.size())
+                    return false;
+                switch (char e = m_Text[m_Pos++])
+                {
+                case 'b':
+                    out.push_back('\b');
+                    break;
+                case 'f':
+                    out.push_back('\f');
+                    break;
+                case 'n':
+                    out.push_back('\n');
+                    break;
+                case 'r':
+                    out.push_back('\r');
+                    break;
+                case 't':
+                    out.push_back('\t');
+                    break;
+                case 'u':
+                    if (!ParseUnicodeEscape(out))
+                        return false;
+                    break;
+                default:
+                    out.push_back(e);
+                }
+            }
+            return false;
+        }
+
+        bool ParseUnicodeEscape(std::string &out)
+        {
+            if (m_Pos + 4 > m_Text.size())
+                return false;
+            unsigned code = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                char h = m_Text[m_Pos++];
+                if (!std::isxdigit((unsigned char)h))
+                    return false;
+                code = code * 16 + (std::isdigit((unsigned char)h) ? h - '0' : std::tolower(h) - 'a' + 10);
+            }
+            // Encode as UTF-8; surrogate pairs are passed through as two separate code points.
+            if (code < 0x80)
+                out.push_back((char)code);
+            else if (code < 0x800)
+            {
+                out.push_back((char)(0xC0 | (code >> 6)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            }
+            else
+            {
+                out.push_back((char)(0xE0 | (code >> 12)));
+                out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            }
+            return true;
+        }
+
+        std::string_view m_Text;
+        size_t m_Pos = 0;
+    };
+}
+
+/**
+ * Looks up an object member by name.
+ *
+ * @param key The member name.
+ * @return A pointer to the first member with that name, or nullptr.
+ */
+const JsonValue *JsonValue::Find(std::string_view key) const
+{
+    for (const auto &member : object)
+        if (member.first == key)
+            return &member.second;
+    return nullptr;
+}
+
+/**
+ * Parses a complete JSON document.
+ *
+ * @param text The JSON text; trailing whitespace is allowed, anything else after the value is not.
+ * @return The parsed value, or std::nullopt on a syntax error.
+ */
+std::optional<JsonValue> ParseJson(std::string_view text)
+{
+    JsonValue value;
+    if (!JsonParser{text}.ParseDocument(value))
+        return std::nullopt;
+    return value;
+}
+
+/**
+ * Writes a value as compact JSON without whitespace.
+ *
+ * Parsed numbers are written as their source token, so they round-trip unchanged whatever the precision of
+ * the stream; other numbers are written with enough digits to round-trip, and as null if they are not finite.
+ *
+ * @param os The stream to write to.
+ * @param value The value to write.
+ */
+void WriteJson(std::ostream &os, const JsonValue &value)
+{
+    switch (value.type)
+    {
+    case JsonValue::Type::Null:
+        os << "null";
+        break;
+    case JsonValue::Type::Bool:
+        os << (value.boolean ? "true" : "false");
+        break;
+    case JsonValue::Type::Number:
+        if (!value.string.empty())
+            os << value.string;
+        else if (std::isfinite(value.number))
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.17g", value.number);
+            os << text;
+        }
+        else
+            os << "null";
+        break;
+    case JsonValue::Type::String:
+        WriteJsonString(os, value.string);
+        break;
+    case JsonValue::Type::Array:
+        os << '[';
+        for (size_t i = 0; i < value.array.size(); ++i)
+        {
+            if (i > 0)
+                os << ',';
+            WriteJson(os, value.array[i]);
+        }
+        os << ']';
+        break;
+    case JsonValue::Type::Object:
+        os << '{';
+        for (size_t i = 0; i < value.object.size(); ++i)
+        {
+            if (i > 0)
+                os << ',';
+            WriteJsonString(os, value.object[i].first);
+            os << ':';
+            WriteJson(os, value.object[i].second);
+        }
+        os << '}';
+        break;
+    }
+}
+
+/**
+ * Writes a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+ *
+ * @param os The stream to write to.
+ * @param text The string to write.
+ */
+void WriteJsonString(std::ostream &os, std::string_view text)
+{
+    os << '"';
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            os << "\\\"";
+            break;
+        case '\\':
+            os << "\\\\";
+            break;
+        case '\n':
+            os << "\\n";
+            break;
+        case '\r':
+            os << "\\r";
+            break;
+        case '\t':
+            os << "\\t";
+            break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+                os << escaped;
+            }
+            else
+                os << c;
+        }
+    }
+    os << '"';
+}
@@ -0,0 +1,57 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Minimal JSON document value.
+ *
+ * This covers what the line-based request formats of the batch and service tools need: objects, arrays,
+ * strings, numbers, booleans and null. Object members keep their input order, and parsed numbers keep their
+ * source text so that ids and other opaque values are written back exactly as they were given.
+ */
+struct JsonValue
+{
+  enum class Type { Null, Bool, Number, String, Array, Object };
+
+  Type type = Type::Null;
+  bool boolean = false;
+  double number = 0.0;
+  std::string string; /**< The text of a string, or the source token of a parsed number. */
+  std::vector<JsonValue> array;
+  std::vector<std::pair<std::string, JsonValue>> object;
+
+  bool IsNumber() const noexcept { return type == Type::Number; }
+  bool IsString() const noexcept { return type == Type::String; }
+  bool IsArray() const noexcept { return type == Type::Array; }
+  bool IsObject() const noexcept { return type == Type::Object; }
+
+  /**
+   * Looks up an object member by name.
+   * @return The member, or nullptr if this is not an object or has no such member.
+   */
+  const JsonValue *Find(std::string_view key) const;
+};
+
+/**
+ * Parses a complete JSON document.
+ * @return The parsed value, or std::nullopt if the text is not valid JSON.
+ */
+std::optional<JsonValue> ParseJson(std::string_view text);
+
+/**
+ * Writes a value as compact JSON.
+ */
+void WriteJson(std::ostream &os, const JsonValue &value);
+
+/**
+ * Writes a string as a quoted and escaped JSON string.
+ */
+void WriteJsonString(std::ostream &os, std::string_view text);
+
+#endif
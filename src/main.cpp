@@ -1,30 +1,141 @@
 #include <optional>
-#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <string>
 #include <io2d.h>
+#include "batch_cli.h"
+#include "cli_args.h"
+#include "read_file.h"
 #include "route_model.h"
 #include "render.h"
 #include "route_planner.h"
+#include "route_query_worker.h"
+#include "tile_pyramid.h"
 
 using namespace std::experimental;
 
-static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+/**
+ * Writes one line per render stage with its median, 95th and 99th percentile time and what it submitted.
+ *
+ * @param render The renderer whose stats to print.
+ * @param os The stream to write to.
+ */
+static void PrintRenderStats(const Render &render, std::ostream &os)
+{
+    os << "Render stages (ms over the last frames that ran them; p50 / p95 / p99, paths, vertices):" << std::endl;
+    for (int stage = 0; stage < Render::StageCount; ++stage)
+    {
+        auto &times = render.StageTimes(stage);
+        auto &submitted = render.StageSubmitted(stage);
+        os << "  " << std::left << std::setw(10) << Render::StageName(stage) << std::right << std::fixed
+           << std::setprecision(2) << std::setw(8) << times.Percentile(50) << std::setw(8) << times.Percentile(95)
+           << std::setw(8) << times.Percentile(99) << std::setw(8) << submitted.paths << std::setw(10)
+           << submitted.vertices << std::endl;
+    }
+    os << std::defaultfloat;
+}
+
+/**
+ * The model and the query worker searching its graph, kept alive together by whoever still uses the worker.
+ */
+struct InteractiveSession
+{
+    explicit InteractiveSession(const std::vector<std::byte> &osm_data) : model{osm_data}, worker{model.Graph()} {}
+
+    RouteModel model;
+    RouteQueryWorker worker;
+};
+
+/**
+ * @brief Shows the map right away and routes in the background while the window keeps drawing.
+ *
+ * Queries are read from standard input, one "start_x start_y end_x end_y" line in percent each, since the
+ * io2d output surface reports no mouse events. Every line goes to the query worker, which drops a query that
+ * is still running when a newer one comes in; the draw callback picks up finished routes without waiting.
+ *
+ * @param osm_data The OpenStreetMap data.
+ * @param render_stats Whether to show and print the render stage times.
+ * @param zoom The zoom of the view, 1 for the whole map.
+ * @param view_center The center of the view in percent, or std::nullopt for the center of the map.
+ * @return The exit code.
+ */
+static int RunInteractive(const std::vector<std::byte> &osm_data, bool render_stats, float zoom,
+                          std::optional<io2d::point_2d> view_center)
 {
-    std::ifstream is{path, std::ios::binary | std::ios::ate};
-    if (!is)
-        return std::nullopt;
+    auto session = std::make_shared<InteractiveSession>(osm_data);
+    Render render{session->model, RoutePath{}};
+    if (zoom > 1.f || view_center)
+    {
+        auto center = view_center.value_or(io2d::point_2d{50.f, 50.f});
+        render.SetView(zoom, center.x(), center.y());
+    }
+    render.ShowStats(render_stats);
 
-    auto size = is.tellg();
-    std::vector<std::byte> contents(size);
+    // Reading standard input blocks, so it has a thread of its own. It cannot be woken when the window closes
+    // and is detached instead; its reference keeps the model and the worker alive as long as it may submit.
+    std::cout << "Enter routes as: start_x start_y end_x end_y" << std::endl;
+    std::thread input{[session]
+                      {
+                          std::string line;
+                          while (std::getline(std::cin, line))
+                          {
+                              std::istringstream is{line};
+                              float start_x, start_y, end_x, end_y;
+                              if (is >> start_x >> start_y >> end_x >> end_y)
+                                  session->worker.Submit(start_x, start_y, end_x, end_y);
+                              else if (!line.empty())
+                                  std::cout << "Expected: start_x start_y end_x end_y" << std::endl;
+                          }
+                      }};
+    input.detach();
 
-    is.seekg(0);
-    is.read((char *)contents.data(), size);
+    auto display = io2d::output_surface{400, 400, io2d::format::argb32, io2d::scaling::none, io2d::refresh_style::fixed, 30};
+    display.size_change_callback([](io2d::output_surface &surface)
+                                 { surface.dimensions(surface.display_dimensions()); });
+    display.draw_callback([&](io2d::output_surface &surface)
+                          {
+                              if (auto result = session->worker.TakeResult())
+                              {
+                                  if (result->path.status == RouteStatus::Found)
+                                      std::cout << "Distance: " << result->path.Distance() << " meters ("
+                                                << result->milliseconds << " ms).\n";
+                                  else if (result->path.status == RouteStatus::Disconnected)
+                                      std::cout << "No route: the start and end points are not connected by roads.\n";
+                                  else
+                                      std::cout << "No route.\n";
+                                  render.SetPath(std::move(result->path));
+                              }
+                              render.Display(surface);
+                          });
+    display.begin_show();
 
-    if (contents.empty())
-        return std::nullopt;
-    return std::move(contents);
+    std::cout << session->worker.Cancelled() << " stale queries were cancelled." << std::endl;
+    if (render_stats)
+        PrintRenderStats(render, std::cout);
+    return 0;
+}
+
+/**
+ * Prints the command line formats of the viewer.
+ */
+static void PrintUsage()
+{
+    std::cout << "Usage: [executable] [-f filename.osm] [--zoom z] [--center x y] [--search-space] [--render-stats]" << std::endl;
+    std::cout << "   or: [executable] [-f filename.osm] --png map.png [--size width height] [--start x y] [--end x y] "
+                 "[--zoom z] [--center x y]"
+              << std::endl;
+    std::cout << "   or: [executable] [-f filename.osm] --interactive [--zoom z] [--center x y] [--render-stats]"
+              << std::endl;
+    std::cout << "   or: [executable] [-f filename.osm] --tiles directory [--max-zoom 0-" << kMaxTileZoom
+              << "] [--threads n]" << std::endl;
+    std::cout << "   or: [executable] [-f filename.osm] --batch requests.jsonl [--out results.jsonl] [--threads n] "
+                 "[--largest-component]"
+              << std::endl;
+    std::cout << "The map file defaults to ../map.osm." << std::endl;
 }
 
 /**
@@ -33,55 +144,207 @@ static std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
  * This function is the entry point of the program. It reads the command line arguments,
  * loads OpenStreetMap data, prompts the user for start and end coordinates, builds a route model,
  * performs A* search, and displays the distance and the rendered results of the search.
+ * With --batch it instead routes a JSONL request file and exits, see RunBatch.
+ * With --png the picture is rendered offscreen and saved instead of shown in a window, which needs no
+ * display; together with --start and --end nothing is prompted either. With --tiles the map is pre-rendered
+ * as a z/x/y tile pyramid for a web viewer, see RenderTilePyramid. With --search-space the nodes the search
+ * explored are drawn on top of the map, coloured by the order in which they were settled. With --render-stats
+ * the time of every render stage is shown as bars in the window and printed on exit. With --interactive the
+ * window opens right away and routes are queried while it runs, see RunInteractive.
  */
 int main(int argc, const char **argv)
 {
-    std::string osm_data_file = "";
-    if (argc > 1)
+    // Headless batch mode: route a JSONL request file without prompting or opening a window.
+    BatchOptions batch_options;
+    switch (ParseBatchOptions(argc, argv, batch_options))
     {
-        for (int i = 1; i < argc; ++i)
-            if (std::string_view{argv[i]} == "-f" && ++i < argc)
-                osm_data_file = argv[i];
+    case BatchRequest::Batch:
+        return RunBatch(batch_options);
+    case BatchRequest::Invalid:
+        std::cerr << "Invalid number in the arguments" << std::endl;
+        PrintUsage();
+        return 1;
+    case BatchRequest::None:
+        break;
     }
-    else
+
+    std::string osm_data_file = "../map.osm";
+    float zoom = 1.f;
+    std::optional<io2d::point_2d> view_center;
+    std::optional<io2d::point_2d> start, end;
+    std::string png_file;
+    int png_width = 800, png_height = 800;
+    TilePyramidOptions tile_options;
+    bool show_search_space = false;
+    bool render_stats = false;
+    bool interactive = false;
+    if (argc == 1)
     {
         std::cout << "To specify a map file use the following format: " << std::endl;
-        std::cout << "Usage: [executable] [-f filename.osm]" << std::endl;
-        osm_data_file = "../map.osm";
+        PrintUsage();
+    }
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view arg{argv[i]};
+            if (arg == "-f" && i + 1 < argc)
+                osm_data_file = argv[++i];
+            else if (arg == "--zoom" && i + 1 < argc)
+                zoom = std::stof(argv[++i]);
+            else if (arg == "--center" && i + 2 < argc)
+            {
+                float x = std::stof(argv[++i]);
+                view_center = io2d::point_2d{x, std::stof(argv[++i])};
+            }
+            else if (arg == "--start" && i + 2 < argc)
+            {
+                float x = std::stof(argv[++i]);
+                start = io2d::point_2d{x, std::stof(argv[++i])};
+            }
+            else if (arg == "--end" && i + 2 < argc)
+            {
+                float x = std::stof(argv[++i]);
+                end = io2d::point_2d{x, std::stof(argv[++i])};
+            }
+            else if (arg == "--search-space")
+                show_search_space = true;
+            else if (arg == "--render-stats")
+                render_stats = true;
+            else if (arg == "--interactive")
+                interactive = true;
+            else if (arg == "--png" && i + 1 < argc)
+                png_file = argv[++i];
+            else if (arg == "--tiles" && i + 1 < argc)
+                tile_options.directory = argv[++i];
+            else if (arg == "--max-zoom" && i + 1 < argc && ParseUnsigned(argv[i + 1], tile_options.max_zoom) &&
+                     tile_options.max_zoom <= kMaxTileZoom)
+                ++i;
+            else if (arg == "--threads" && i + 1 < argc && ParseUnsigned(argv[i + 1], tile_options.threads))
+                ++i;
+            else if (arg == "--size" && i + 2 < argc)
+            {
+                png_width = std::stoi(argv[++i]);
+                png_height = std::stoi(argv[++i]);
+            }
+            else
+            {
+                std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+                PrintUsage();
+                return 1;
+            }
+        }
+    }
+    catch (const std::logic_error &)
+    {
+        // std::stof and friends throw std::invalid_argument or std::out_of_range on a malformed number.
+        std::cerr << "Invalid number in the arguments" << std::endl;
+        PrintUsage();
+        return 1;
     }
 
-    std::vector<std::byte> osm_data;
+    std::cout << "Reading OpenStreetMap data from the following file: " << osm_data_file << std::endl;
+    auto data = ReadFile(osm_data_file);
+    if (!data)
+    {
+        std::cerr << "Failed to read " << osm_data_file << std::endl;
+        return 1;
+    }
+    std::vector<std::byte> osm_data = std::move(*data);
 
-    if (osm_data.empty() && !osm_data_file.empty())
+    // Tile mode: pre-render the map without a route into directory/z/x/y.png.
+    if (!tile_options.directory.empty())
     {
-        std::cout << "Reading OpenStreetMap data from the following file: " << osm_data_file << std::endl;
-        auto data = ReadFile(osm_data_file);
-        if (!data)
-            std::cout << "Failed to read." << std::endl;
-        else
-            osm_data = std::move(*data);
+        RouteModel model{osm_data};
+        Render render{model, RoutePath{}};
+        auto stats = RenderTilePyramid(render, tile_options);
+        std::cout << "Rendered " << stats.tiles << " tiles up to zoom level " << tile_options.max_zoom << " in "
+                  << stats.seconds << " s (" << stats.TilesPerSecond() << " tiles/s)." << std::endl;
+        if (stats.failed > 0)
+        {
+            std::cerr << "Failed to write " << stats.failed << " tiles to " << tile_options.directory << std::endl;
+            return 1;
+        }
+        return 0;
     }
 
+    // Interactive mode: open the window at once and route in the background.
+    if (interactive)
+        return RunInteractive(osm_data, render_stats, zoom, view_center);
+
     float start_x, start_y, end_x, end_y;
-    std::cout << "Please Enter start_x: ";
-    std::cin >> start_x;
-    std::cout << "Please Enter start_y: ";
-    std::cin >> start_y;
-    std::cout << "Please Enter end_x: ";
-    std::cin >> end_x;
-    std::cout << "Please Enter end_y: ";
-    std::cin >> end_y;
+    if (start)
+    {
+        start_x = start->x();
+        start_y = start->y();
+    }
+    else
+    {
+        std::cout << "Please Enter start_x: ";
+        std::cin >> start_x;
+        std::cout << "Please Enter start_y: ";
+        std::cin >> start_y;
+    }
+    if (end)
+    {
+        end_x = end->x();
+        end_y = end->y();
+    }
+    else
+    {
+        std::cout << "Please Enter end_x: ";
+        std::cin >> end_x;
+        std::cout << "Please Enter end_y: ";
+        std::cin >> end_y;
+    }
     // Build Model.
     RouteModel model{osm_data};
 
     // Create RoutePlanner object and perform A* search.
     RoutePlanner route_planner{model, start_x, start_y, end_x, end_y};
-    route_planner.AStarSearch();
+    SearchTrace trace;
+    route_planner.AStarSearch(show_search_space ? &trace : nullptr);
 
-    std::cout << "Distance: " << route_planner.GetDistance() << " meters. \n";
+    if (route_planner.Path().status == RouteStatus::Disconnected)
+        std::cout << "No route: the start and end points are not connected by roads.\n";
+    else
+        std::cout << "Distance: " << route_planner.GetDistance() << " meters. \n";
+    if (show_search_space)
+        std::cout << "Search space: " << trace.settled.size() << " nodes settled, " << trace.frontier.size()
+                  << " left on the frontier.\n";
 
     // Render results of search.
-    Render render{model};
+    Render render{model, route_planner.Path()};
+    render.SetSearchTrace(std::move(trace));
+    render.ShowStats(render_stats);
+    if (zoom > 1.f || view_center)
+    {
+        auto center = view_center.value_or(io2d::point_2d{50.f, 50.f});
+        render.SetView(zoom, center.x(), center.y());
+    }
+
+    // Headless mode: draw the same picture into an in-memory image and save it, without opening a window.
+    if (!png_file.empty())
+    {
+        if (png_width <= 0 || png_height <= 0)
+        {
+            std::cerr << "Invalid image size " << png_width << "x" << png_height << std::endl;
+            return 1;
+        }
+        auto image = io2d::image_surface{io2d::format::argb32, png_width, png_height};
+        render.Display(image);
+        std::error_code error;
+        image.save(png_file, io2d::image_file_format::png, error);
+        if (error)
+        {
+            std::cerr << "Failed to write " << png_file << ": " << error.message() << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << png_width << "x" << png_height << " image to " << png_file << std::endl;
+        if (render_stats)
+            PrintRenderStats(render, std::cout);
+        return 0;
+    }
 
     auto display = io2d::output_surface{400, 400, io2d::format::argb32, io2d::scaling::none, io2d::refresh_style::fixed, 30};
     display.size_change_callback([](io2d::output_surface &surface)
@@ -89,4 +352,14 @@ int main(int argc, const char **argv)
     display.draw_callback([&](io2d::output_surface &surface)
                           { render.Display(surface); });
     display.begin_show();
+
+    size_t drawn = 0, culled = 0;
+    for (auto &layer : render.Culling())
+    {
+        drawn += layer.drawn;
+        culled += layer.culled;
+    }
+    std::cout << "Last view: " << drawn << " features drawn, " << culled << " culled." << std::endl;
+    if (render_stats)
+        PrintRenderStats(render, std::cout);
 }
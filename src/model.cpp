@@ -219,25 +219,53 @@ void Model::LoadData(const std::vector<std::byte> &xml)
     }
 }
 
+static constexpr double kPi = 3.14159265358979323846264338327950288;
+static constexpr double kDegToRad = 2. * kPi / 360.;
+static constexpr double kEarthRadius = 6378137.;
+
+static double Lat2Ym(double lat)
+{
+    return log(tan(lat * kDegToRad / 2 + kPi / 4)) / 2 * kEarthRadius;
+}
+
+static double Lon2Xm(double lon)
+{
+    return lon * kDegToRad / 2 * kEarthRadius;
+}
+
 void Model::AdjustCoordinates()
 {
-    const auto pi = 3.14159265358979323846264338327950288;
-    const auto deg_to_rad = 2. * pi / 360.;
-    const auto earth_radius = 6378137.;
-    const auto lat2ym = [&](double lat)
-    { return log(tan(lat * deg_to_rad / 2 + pi / 4)) / 2 * earth_radius; };
-    const auto lon2xm = [&](double lon)
-    { return lon * deg_to_rad / 2 * earth_radius; };
-    const auto dx = lon2xm(m_MaxLon) - lon2xm(m_MinLon);
-    const auto dy = lat2ym(m_MaxLat) - lat2ym(m_MinLat);
-    const auto min_y = lat2ym(m_MinLat);
-    const auto min_x = lon2xm(m_MinLon);
+    const auto dx = Lon2Xm(m_MaxLon) - Lon2Xm(m_MinLon);
+    const auto dy = Lat2Ym(m_MaxLat) - Lat2Ym(m_MinLat);
     m_MetricScale = std::min(dx, dy);
     for (auto &node : m_Nodes)
+        node = Project(node.y, node.x);
+}
+
+Model::Node Model::Project(double lat, double lon) const noexcept
+{
+    Node node;
+    node.x = (Lon2Xm(lon) - Lon2Xm(m_MinLon)) / m_MetricScale;
+    node.y = (Lat2Ym(lat) - Lat2Ym(m_MinLat)) / m_MetricScale;
+    return node;
+}
+
+std::size_t Model::MemoryUsage() const noexcept
+{
+    auto bytes = [](const auto &v)
+    { return v.capacity() * sizeof(v[0]); };
+    auto mp_bytes = [&](const auto &mps)
     {
-        node.x = (lon2xm(node.x) - min_x) / m_MetricScale;
-        node.y = (lat2ym(node.y) - min_y) / m_MetricScale;
-    }
+        std::size_t total = bytes(mps);
+        for (const Multipolygon &mp : mps)
+            total += bytes(mp.outer) + bytes(mp.inner);
+        return total;
+    };
+
+    std::size_t total = sizeof(*this) + bytes(m_Nodes) + bytes(m_Ways) + bytes(m_Roads) + bytes(m_Railways);
+    for (const auto &way : m_Ways)
+        total += bytes(way.nodes);
+    return total + mp_bytes(m_Buildings) + mp_bytes(m_Leisures) + mp_bytes(m_Waters) + mp_bytes(m_Landuses);
 }
 
 static bool TrackRec(const std::vector<int> &open_ways,
@@ -69,6 +69,25 @@ public:
     auto &Landuses() const noexcept { return m_Landuses; }
     
     auto &Railways() const noexcept { return m_Railways; }
+
+    auto MinLat() const noexcept { return m_MinLat; }
+    auto MaxLat() const noexcept { return m_MaxLat; }
+    auto MinLon() const noexcept { return m_MinLon; }
+    auto MaxLon() const noexcept { return m_MaxLon; }
+
+    /**
+     * @brief Converts a geographic position into the normalized map coordinates of the nodes.
+     *
+     * @param lat The latitude in degrees.
+     * @param lon The longitude in degrees.
+     * @return The position with x and y in the same units as Nodes().
+     */
+    Node Project(double lat, double lon) const noexcept;
+
+    /**
+     * @brief Estimates the heap memory held by the map data in bytes.
+     */
+    std::size_t MemoryUsage() const noexcept;
     
 private:
     void AdjustCoordinates();
@@ -0,0 +1,105 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class RadixHeap
+ * @brief Monotone priority queue for non-negative float keys.
+ *
+ * A radix heap only allows pushing keys that are not smaller than the last key popped, which is always true
+ * in Dijkstra's algorithm with non-negative edge lengths. Non-negative IEEE floats sort the same way as
+ * their bit patterns read as unsigned integers, so the keys are bucketed by the highest bit in which they
+ * differ from the last popped key. Each entry moves to a lower bucket at most 32 times, and a pop only scans
+ * the smallest non-empty bucket, which makes it cheaper than a binary heap for large one-to-all searches.
+ */
+class RadixHeap
+{
+public:
+  void Clear()
+  {
+    for (auto &bucket : m_Buckets)
+      bucket.clear();
+    m_Size = 0;
+    m_Last = 0;
+  }
+
+  bool Empty() const noexcept { return m_Size == 0; }
+
+  /**
+   * Adds a node with the given key, which must not be smaller than the last popped key.
+   */
+  void Push(float key, int node)
+  {
+    auto bits = ToBits(key);
+    assert(bits >= m_Last);
+    m_Buckets[BucketOf(bits)].emplace_back(bits, node);
+    ++m_Size;
+  }
+
+  /**
+   * Removes an entry with the smallest key.
+   * @return The key and the node of the entry.
+   */
+  std::pair<float, int> Pop()
+  {
+    assert(m_Size > 0);
+    if (m_Buckets[0].empty())
+    {
+      size_t i = 1;
+      while (m_Buckets[i].empty())
+        ++i;
+      auto &bucket = m_Buckets[i];
+      auto min_bits = std::numeric_limits<std::uint32_t>::max();
+      for (auto &entry : bucket)
+        min_bits = std::min(min_bits, entry.first);
+      m_Last = min_bits;
+      for (auto &entry : bucket)
+        m_Buckets[BucketOf(entry.first)].push_back(entry);
+      bucket.clear();
+    }
+    auto entry = m_Buckets[0].back();
+    m_Buckets[0].pop_back();
+    --m_Size;
+    return {FromBits(entry.first), entry.second};
+  }
+
+private:
+  static std::uint32_t ToBits(float key) noexcept
+  {
+    std::uint32_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return bits;
+  }
+
+  static float FromBits(std::uint32_t bits) noexcept
+  {
+    float key;
+    std::memcpy(&key, &bits, sizeof(key));
+    return key;
+  }
+
+  size_t BucketOf(std::uint32_t bits) const noexcept
+  {
+    auto diff = bits ^ m_Last;
+    size_t bucket = 0;
+    while (diff)
+    {
+      ++bucket;
+      diff >>= 1;
+    }
+    return bucket;
+  }
+
+  std::array<std::vector<std::pair<std::uint32_t, int>>, 33> m_Buckets;
+  size_t m_Size = 0;
+  std::uint32_t m_Last = 0;
+};
+
+#endif
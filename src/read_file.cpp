@@ -0,0 +1,25 @@
+#include "read_file.h"
+#include <fstream>
+
+/**
+ * @brief Reads a whole file into memory.
+ *
+ * @param path The path of the file.
+ * @return The contents of the file, or std::nullopt if it cannot be opened or is empty.
+ */
+std::optional<std::vector<std::byte>> ReadFile(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary | std::ios::ate};
+    if (!is)
+        return std::nullopt;
+
+    auto size = is.tellg();
+    std::vector<std::byte> contents(size);
+
+    is.seekg(0);
+    is.read((char *)contents.data(), size);
+
+    if (contents.empty())
+        return std::nullopt;
+    return contents;
+}
@@ -0,0 +1,15 @@
+#ifndef READ_FILE_H
+#define READ_FILE_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Reads a whole file into memory, e.g. an OSM file before it is parsed.
+ * @return The contents, or std::nullopt if the file cannot be read or is empty.
+ */
+std::optional<std::vector<std::byte>> ReadFile(const std::string &path);
+
+#endif
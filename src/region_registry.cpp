@@ -0,0 +1,242 @@
+#include "region_registry.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <vector>
+#include "read_file.h"
+
+/**
+ * @brief Reads the bounds of an OSM file.
+ *
+ * OSM exports put <bounds> right after the <osm> element, so only the first few kilobytes are scanned.
+ *
+ * @param osm_data_file The path of the map.
+ * @param bounds Receives the bounds.
+ * @return True if all four attributes were found.
+ */
+bool ReadOsmBounds(const std::string &osm_data_file, GeoBounds &bounds)
+{
+    std::ifstream is{osm_data_file, std::ios::binary};
+    if (!is)
+        return false;
+    std::string head(64 * 1024, '\0');
+    is.read(head.data(), head.size());
+    head.resize(is.gcount());
+
+    auto element = head.find("<bounds");
+    if (element == std::string::npos)
+        return false;
+    auto element_end = head.find('>', element);
+    if (element_end == std::string::npos)
+        return false;
+    std::string_view tag{head.data() + element, element_end - element};
+
+    auto attribute = [&](std::string_view name, double &value)
+    {
+        auto pos = tag.find(std::string{" "} + std::string{name} + "=\"");
+        if (pos == std::string_view::npos)
+            return false;
+        value = std::atof(std::string{tag.substr(pos + name.size() + 3)}.c_str());
+        return true;
+    };
+    return attribute("minlat", bounds.min_lat) && attribute("maxlat", bounds.max_lat) &&
+           attribute("minlon", bounds.min_lon) && attribute("maxlon", bounds.max_lon);
+}
+
+/**
+ * @brief Adds a region without loading it.
+ *
+ * @param name The unique name of the region.
+ * @param osm_data_file The path of the region's map.
+ * @return True if the region was added.
+ */
+bool RegionRegistry::Register(const std::string &name, const std::string &osm_data_file)
+{
+    auto region = std::make_unique<Region>();
+    region->name = name;
+    region->osm_data_file = osm_data_file;
+    if (!ReadOsmBounds(osm_data_file, region->bounds))
+    {
+        std::cerr << "Failed to read the bounds of " << osm_data_file << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Regions.emplace(name, std::move(region)).second;
+}
+
+/**
+ * Moves a loaded region to the front of the LRU list.
+ *
+ * @param region The region; m_Mutex must be held.
+ */
+void RegionRegistry::Touch(Region &region)
+{
+    m_Lru.splice(m_Lru.begin(), m_Lru, region.lru);
+}
+
+/**
+ * @brief Returns the model of a region, loading it on first use.
+ *
+ * The model is built without holding the registry lock, so other regions stay available during the load.
+ * Afterwards the least recently used regions are evicted until the loaded models fit into the budget
+ * again; the region that was just requested is never evicted. Dropped models are released after the lock
+ * is given up, so their destruction does not hold up other requests.
+ *
+ * @param name The name of the region.
+ * @return The model, or nullptr.
+ */
+std::shared_ptr<const RouteModel> RegionRegistry::Get(const std::string &name)
+{
+    Region *region;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto it = m_Regions.find(name);
+        if (it == m_Regions.end())
+            return nullptr;
+        region = it->second.get();
+        if (region->model)
+        {
+            Touch(*region);
+            return region->model;
+        }
+    }
+
+    std::lock_guard<std::mutex> load_lock(region->load_mutex);
+    {
+        // Another request may have loaded the region while this one waited.
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (region->model)
+        {
+            Touch(*region);
+            return region->model;
+        }
+    }
+
+    std::shared_ptr<const RouteModel> model;
+    if (auto data = ReadFile(region->osm_data_file))
+    {
+        try
+        {
+            model = std::make_shared<const RouteModel>(*data);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Failed to load " << region->osm_data_file << ": " << e.what() << std::endl;
+        }
+    }
+    if (!model)
+        return nullptr;
+
+    std::vector<std::shared_ptr<const RouteModel>> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        region->model = model;
+        region->memory = model->MemoryUsage();
+        m_MemoryUsage += region->memory;
+        region->lru = m_Lru.insert(m_Lru.begin(), region);
+
+        while (m_MemoryUsage > m_MemoryBudget && m_Lru.back() != region)
+        {
+            Region *victim = m_Lru.back();
+            m_Lru.pop_back();
+            m_MemoryUsage -= victim->memory;
+            victim->memory = 0;
+            evicted.push_back(std::move(victim->model));
+            victim->model.reset();
+        }
+    }
+    return model;
+}
+
+/**
+ * @brief Finds the region covering a position.
+ *
+ * @param lat The latitude in degrees.
+ * @param lon The longitude in degrees.
+ * @return The name of the smallest region containing the position, or an empty string.
+ */
+std::string RegionRegistry::FindRegion(double lat, double lon) const
+{
+    return FindRegion(lat, lon, lat, lon);
+}
+
+/**
+ * @brief Finds the region covering two positions.
+ *
+ * With nested extracts, e.g. a city inside its metro area, the smallest region that covers only the start
+ * may miss the end, so both positions are checked against every region.
+ *
+ * @param start_lat The latitude of the start.
+ * @param start_lon The longitude of the start.
+ * @param end_lat The latitude of the end.
+ * @param end_lon The longitude of the end.
+ * @return The name of the smallest region containing both positions, or an empty string.
+ */
+std::string RegionRegistry::FindRegion(double start_lat, double start_lon, double end_lat, double end_lon) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const Region *best = nullptr;
+    for (const auto &entry : m_Regions)
+    {
+        const Region &region = *entry.second;
+        if (region.bounds.Contains(start_lat, start_lon) && region.bounds.Contains(end_lat, end_lon) &&
+            (!best || region.bounds.Area() < best->bounds.Area()))
+            best = &region;
+    }
+    return best ? best->name : std::string{};
+}
+
+/**
+ * @brief Routes between two geographic positions.
+ *
+ * Picks the smallest region that covers both positions, projects them into the region's map coordinates
+ * and runs an A* search.
+ *
+ * @param start_lat The latitude of the start.
+ * @param start_lon The longitude of the start.
+ * @param end_lat The latitude of the end.
+ * @param end_lon The longitude of the end.
+ * @param workspace The scratch memory of the calling thread.
+ * @param path Receives the route; empty if there is none.
+ * @return The model that was searched; keep it alive while using the node indices of the path.
+ */
+std::shared_ptr<const RouteModel> RegionRegistry::Route(double start_lat, double start_lon, double end_lat,
+                                                        double end_lon, SearchWorkspace &workspace, RoutePath &path)
+{
+    path.nodes.clear();
+    path.distances.clear();
+
+    std::string name = FindRegion(start_lat, start_lon, end_lat, end_lon);
+    if (name.empty())
+        return nullptr;
+    auto model = Get(name);
+    if (!model)
+        return nullptr;
+
+    const RoadGraph &graph = model->Graph();
+    auto start = model->Project(start_lat, start_lon);
+    auto end = model->Project(end_lat, end_lon);
+    FindShortestPath(graph, graph.FindClosestNode((float)start.x, (float)start.y),
+                     graph.FindClosestNode((float)end.x, (float)end.y), workspace, path);
+    return model;
+}
+
+/**
+ * @return The memory usage of all loaded models in bytes.
+ */
+std::size_t RegionRegistry::MemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_MemoryUsage;
+}
+
+/**
+ * @return The number of regions whose model is loaded.
+ */
+std::size_t RegionRegistry::LoadedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Lru.size();
+}
@@ -0,0 +1,113 @@
+#ifndef REGION_REGISTRY_H
+#define REGION_REGISTRY_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "graph_search.h"
+#include "route_model.h"
+#include "route_path.h"
+
+/**
+ * @brief Geographic bounding box of a map extract in degrees.
+ */
+struct GeoBounds
+{
+  double min_lat = 0.;
+  double max_lat = 0.;
+  double min_lon = 0.;
+  double max_lon = 0.;
+
+  bool Contains(double lat, double lon) const noexcept
+  {
+    return lat >= min_lat && lat <= max_lat && lon >= min_lon && lon <= max_lon;
+  }
+  double Area() const noexcept { return (max_lat - min_lat) * (max_lon - min_lon); }
+};
+
+/**
+ * @class RegionRegistry
+ * @brief Hosts the route models of many map extracts in one process under a shared memory budget.
+ *
+ * Regions are registered with their OSM file, of which only the bounds are read up front. A region's model
+ * is built on its first request and kept in least-recently-used order; when the loaded models exceed the
+ * memory budget, the least recently used ones are dropped until the budget is met again. Queries that still
+ * hold a dropped model finish on it, and it is freed when they release it.
+ *
+ * All methods are thread-safe. Loading a cold region only blocks requests for that same region.
+ */
+class RegionRegistry
+{
+public:
+  /**
+   * @param memory_budget The memory the loaded models may use together, in bytes.
+   */
+  explicit RegionRegistry(std::size_t memory_budget) : m_MemoryBudget(memory_budget) {}
+
+  /**
+   * Adds a region without loading it.
+   * @return False if the name is taken or the bounds of the file could not be read.
+   */
+  bool Register(const std::string &name, const std::string &osm_data_file);
+
+  /**
+   * Returns the model of a region, loading it first if needed.
+   * @return The model, or nullptr if the region is unknown or failed to load.
+   */
+  std::shared_ptr<const RouteModel> Get(const std::string &name);
+
+  /**
+   * Finds the region whose bounds contain a position; if several do, the smallest one is taken.
+   * @return The region name, or an empty string if no region covers the position.
+   */
+  std::string FindRegion(double lat, double lon) const;
+
+  /**
+   * Finds the region whose bounds contain both positions; if several do, the smallest one is taken.
+   * @return The region name, or an empty string if no region covers both positions.
+   */
+  std::string FindRegion(double start_lat, double start_lon, double end_lat, double end_lon) const;
+
+  /**
+   * Routes between two geographic positions in the region that contains both of them.
+   * @param workspace The scratch memory of the calling thread.
+   * @param path Receives the route; it refers to the nodes of the returned model.
+   * @return The model the path was computed on, or nullptr if no region covers both positions.
+   */
+  std::shared_ptr<const RouteModel> Route(double start_lat, double start_lon, double end_lat, double end_lon,
+                                          SearchWorkspace &workspace, RoutePath &path);
+
+  std::size_t MemoryUsage() const;
+  std::size_t LoadedCount() const;
+
+private:
+  struct Region
+  {
+    std::string name;
+    std::string osm_data_file;
+    GeoBounds bounds;
+    std::shared_ptr<const RouteModel> model; /**< Null while the region is not loaded. */
+    std::size_t memory = 0;                  /**< The memory usage of the loaded model. */
+    std::list<Region *>::iterator lru;       /**< The position in m_Lru while loaded. */
+    std::mutex load_mutex;                   /**< Serializes loading of this region. */
+  };
+
+  void Touch(Region &region);
+
+  std::size_t m_MemoryBudget;
+  mutable std::mutex m_Mutex; /**< Guards everything below except Region::load_mutex. */
+  std::unordered_map<std::string, std::unique_ptr<Region>> m_Regions;
+  std::list<Region *> m_Lru; /**< The loaded regions, most recently used first. */
+  std::size_t m_MemoryUsage = 0;
+};
+
+/**
+ * Reads the <bounds> element from the beginning of an OSM file without parsing the whole file.
+ * @return False if the file has no bounds near its start.
+ */
+bool ReadOsmBounds(const std::string &osm_data_file, GeoBounds &bounds);
+
+#endif
@@ -1,55 +1,408 @@
 #include "render.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
+// Features reaching this far outside the surface are still drawn, so that wide strokes do not get cut off.
+static constexpr float kCullMarginPixels = 16.f;
+// Simplified geometry may deviate this far from the original; less is invisible after antialiasing.
+static constexpr float kLodTolerancePixels = 0.5f;
+// Buildings whose bounding box covers fewer pixels than this are not drawn at all.
+static constexpr float kMinBuildingPixelArea = 4.f;
+// The side of the square drawn for every node of the search space overlay.
+static constexpr float kTraceDotPixels = 3.f;
+// The stats overlay draws one bar per stage, this long per millisecond.
+static constexpr float kStatsPixelsPerMillisecond = 20.f;
+
 static float RoadMetricWidth(Model::Road::Type type);
 static io2d::rgba_color RoadColor(Model::Road::Type type);
 static io2d::dashes RoadDashes(Model::Road::Type type);
 static io2d::point_2d ToPoint2D(const Model::Node &node) noexcept;
+static double Milliseconds(std::chrono::steady_clock::duration duration) noexcept;
 
-Render::Render(RouteModel &model) : m_Model(model)
+Render::Render(RouteModel &model, RoutePath path) : m_Model(model), m_Path(std::move(path)), m_Geometry(model)
 {
+    auto corner = m_Model.Project(m_Model.MaxLat(), m_Model.MaxLon());
+    m_MapExtent = static_cast<float>(std::max({corner.x, corner.y, 1e-6}));
     BuildRoadReps();
     BuildLanduseBrushes();
+    BuildFeatureIndexes();
 }
 
-void Render::Display(io2d::output_surface &surface)
+void Render::SetView(float zoom, float center_x, float center_y)
 {
-    m_Scale = static_cast<float>(std::min(surface.dimensions().x(), surface.dimensions().y()));
-    m_PixelsInMeter = static_cast<float>(m_Scale / m_Model.MetricScale());
-    m_Matrix = io2d::matrix_2d::create_scale({m_Scale, -m_Scale}) *
-               io2d::matrix_2d::create_translate({0.f, static_cast<float>(surface.dimensions().y())});
+    m_Zoom = std::max(zoom, 1.f);
+    m_ViewCenter = io2d::point_2d{center_x / 100.f, center_y / 100.f};
+    m_FrameValid = false;
+}
 
-    surface.paint(m_BackgroundFillBrush);
-    DrawLanduses(surface);
-    DrawLeisure(surface);
-    DrawWater(surface);
-    DrawRailways(surface);
-    DrawHighways(surface);
-    DrawBuildings(surface);
+void Render::ResetView()
+{
+    m_Zoom = 1.f;
+    m_ViewCenter.reset();
+    m_FrameValid = false;
+}
+
+void Render::SetPath(RoutePath path)
+{
+    m_Path = std::move(path);
+    m_PathLineValid = false;
+}
+
+void Render::SetSearchTrace(SearchTrace trace)
+{
+    m_Trace = std::move(trace);
+    m_TracePathsValid = false;
+}
+
+template <typename Surface>
+void Render::Display(Surface &surface)
+{
+    auto dimensions = surface.dimensions();
+    if (dimensions.x() <= 0 || dimensions.y() <= 0)
+        return;
+    auto frame_start = std::chrono::steady_clock::now();
+    UpdateTransform(dimensions);
+
+    // The map layers only change with the transform. Rasterize them once into an offscreen surface and keep
+    // it as a brush; the vector paths are not needed again until the next transform change rebuilds them.
+    Submitted frame_submitted;
+    if (!m_BaseLayer)
+    {
+        io2d::image_surface base{io2d::format::argb32, dimensions.x(), dimensions.y()};
+        std::array<double, LayerCount> layer_times{};
+        DrawMap(base, m_Frame, &layer_times);
+        m_BaseLayer.emplace(std::move(base));
+        for (int layer = 0; layer < LayerCount; ++layer)
+        {
+            m_StageTimes[layer].Add(layer_times[layer]);
+            m_StageSubmitted[layer] = m_Frame.submitted[layer];
+            frame_submitted.paths += m_Frame.submitted[layer].paths;
+            frame_submitted.vertices += m_Frame.submitted[layer].vertices;
+        }
+        for (auto &layer : m_Frame.layers)
+            layer.paths = {};
+        m_Frame.road_paths = {};
+    }
+
+    auto route_start = std::chrono::steady_clock::now();
+    surface.paint(*m_BaseLayer);
+    DrawSearchSpace(surface);
     DrawPath(surface);
     DrawStartPosition(surface);
     DrawEndPosition(surface);
+    auto frame_end = std::chrono::steady_clock::now();
+
+    m_StageTimes[RouteStage].Add(Milliseconds(frame_end - route_start));
+    m_StageSubmitted[RouteStage] = RouteSubmitted();
+    m_StageTimes[FrameStage].Add(Milliseconds(frame_end - frame_start));
+    frame_submitted.paths += m_StageSubmitted[RouteStage].paths;
+    frame_submitted.vertices += m_StageSubmitted[RouteStage].vertices;
+    m_StageSubmitted[FrameStage] = frame_submitted;
+
+    // The overlay is drawn after the clock stopped, so it does not show up in its own numbers.
+    if (m_ShowStats)
+        DrawStats(surface);
+}
+
+const char *Render::StageName(int stage) noexcept
+{
+    static constexpr const char *names[StageCount] = {"landuses", "leisures", "waters", "railways",
+                                                      "roads",    "buildings", "route", "frame"};
+    return stage >= 0 && stage < StageCount ? names[stage] : "";
+}
+
+// The paths and vertices the route stage submits: the search space dots, the route line and its two markers.
+Render::Submitted Render::RouteSubmitted() const
+{
+    Submitted submitted;
+    submitted.paths = m_TraceBins.size() + (m_TraceFrontier ? 1 : 0);
+    submitted.vertices = 4 * (m_Trace.settled.size() + m_Trace.frontier.size());
+    if (!m_Path.Empty())
+    {
+        submitted.paths += 3;
+        submitted.vertices += m_Path.nodes.size() + 2 * 4;
+    }
+    return submitted;
+}
+
+template <typename Surface>
+void Render::DisplayTile(Surface &surface, int z, int x, int y) const
+{
+    Frame frame;
+    frame.dimensions = surface.dimensions();
+    auto side = m_MapExtent / static_cast<float>(1 << z);
+    frame.scale = static_cast<float>(std::min(frame.dimensions.x(), frame.dimensions.y())) / side;
+    frame.matrix = io2d::matrix_2d::create_translate({-x * side, -(m_MapExtent - y * side)}) *
+                   io2d::matrix_2d::create_scale({frame.scale, -frame.scale});
+    BuildFrame(frame);
+    DrawMap(surface, frame);
+}
+
+template <typename Surface>
+void Render::DrawMap(Surface &surface, const Frame &frame, std::array<double, LayerCount> *milliseconds) const
+{
+    surface.paint(m_BackgroundFillBrush);
+    auto start = std::chrono::steady_clock::now();
+    auto lap = [&](Layer layer)
+    {
+        if (!milliseconds)
+            return;
+        auto now = std::chrono::steady_clock::now();
+        (*milliseconds)[layer] = Milliseconds(now - start);
+        start = now;
+    };
+    DrawLanduses(surface, frame);
+    lap(Landuses);
+    DrawLeisure(surface, frame);
+    lap(Leisures);
+    DrawWater(surface, frame);
+    lap(Waters);
+    DrawRailways(surface, frame);
+    lap(Railways);
+    DrawHighways(surface, frame);
+    lap(Roads);
+    DrawBuildings(surface, frame);
+    lap(Buildings);
+}
+
+// Recomputes the map-to-device transform for a surface size and the view. The cached paths are in device
+// space, so they are only thrown away when the size or the view, and with it the transform, actually changes.
+void Render::UpdateTransform(io2d::display_point dimensions)
+{
+    if (!m_FrameValid || dimensions.x() != m_Frame.dimensions.x() || dimensions.y() != m_Frame.dimensions.y())
+    {
+        // Without a view the map's origin sits in the bottom left corner, as if the center were half a surface in.
+        auto extent = static_cast<float>(std::min(dimensions.x(), dimensions.y()));
+        auto center = m_ViewCenter.value_or(io2d::point_2d{dimensions.x() / (2.f * extent), dimensions.y() / (2.f * extent)});
+        m_Frame.dimensions = dimensions;
+        m_Frame.scale = extent * m_Zoom;
+        m_Frame.matrix = io2d::matrix_2d::create_translate({-center.x(), -center.y()}) *
+                         io2d::matrix_2d::create_scale({m_Frame.scale, -m_Frame.scale}) *
+                         io2d::matrix_2d::create_translate({dimensions.x() / 2.f, dimensions.y() / 2.f});
+        BuildFrame(m_Frame);
+        m_FrameValid = true;
+        m_BaseLayer.reset();
+        m_PathLineValid = false;
+        m_TracePathsValid = false;
+    }
+    if (!m_PathLineValid)
+    {
+        m_PathLine = PathLine();
+        m_PathLineValid = true;
+    }
+    if (!m_TracePathsValid)
+    {
+        BuildTracePaths();
+        m_TracePathsValid = true;
+    }
 }
 
-void Render::DrawPath(io2d::output_surface &surface) const
+// The part of the map that is visible with a frame's transform, plus the culling margin, in map units.
+BoundingBox Render::ViewBounds(const Frame &frame) const
 {
+    auto inverse = frame.matrix.inverse();
+    auto corner_a = inverse.transform_pt({-kCullMarginPixels, -kCullMarginPixels});
+    auto corner_b = inverse.transform_pt({frame.dimensions.x() + kCullMarginPixels, frame.dimensions.y() + kCullMarginPixels});
+    BoundingBox view;
+    view.Extend(corner_a.x(), corner_a.y());
+    view.Extend(corner_b.x(), corner_b.y());
+    return view;
+}
+
+// Builds the paths of the features in view for a frame whose dimensions, matrix and scale are set.
+void Render::BuildFrame(Frame &frame) const
+{
+    frame.pixels_in_meter = static_cast<float>(frame.scale / m_Model.MetricScale());
+    frame.level = GeometryLevels::LevelFor(kLodTolerancePixels / frame.scale);
+
+    auto view = ViewBounds(frame);
+    for (int layer = 0; layer < LayerCount; ++layer)
+    {
+        auto &paths = frame.layers[layer];
+        m_Indexes[layer].Query(view, paths.features);
+        if (layer == Buildings)
+        {
+            auto min_area = kMinBuildingPixelArea / (frame.scale * frame.scale);
+            auto tiny = [&](int feature)
+            {
+                auto &box = m_Indexes[layer].Box(feature);
+                return (box.max_x - box.min_x) * (box.max_y - box.min_y) < min_area;
+            };
+            paths.features.erase(std::remove_if(paths.features.begin(), paths.features.end(), tiny), paths.features.end());
+        }
+        paths.paths.clear();
+        if (layer != Roads)
+        {
+            paths.paths.reserve(paths.features.size());
+            for (int feature : paths.features)
+                paths.paths.push_back(FeaturePath(static_cast<Layer>(layer), feature, frame));
+        }
+        frame.culling[layer].drawn = paths.features.size();
+        frame.culling[layer].culled = m_StyledCounts[layer] - paths.features.size();
+        frame.submitted[layer] = {paths.paths.size(), 0};
+        for (int feature : paths.features)
+            frame.submitted[layer].vertices += FeatureVertices(static_cast<Layer>(layer), feature, frame.level);
+    }
+    BuildRoadPaths(frame);
+    frame.submitted[Roads].paths = std::count_if(frame.road_paths.begin(), frame.road_paths.end(),
+                                                 [](auto &path) { return path.has_value(); });
+}
+
+// Merges the visible roads into one path per road type. The model keeps the roads sorted by type and the
+// index returns them in model order, so every type is one run of features.
+void Render::BuildRoadPaths(Frame &frame) const
+{
+    auto &roads = m_Model.Roads();
+    auto &features = frame.layers[Roads].features;
+    frame.road_paths = {};
+    auto pb = io2d::path_builder{};
+    pb.matrix(frame.matrix);
+    for (size_t begin = 0, end; begin < features.size(); begin = end)
+    {
+        auto type = roads[features[begin]].type;
+        for (end = begin; end < features.size() && roads[features[end]].type == type; ++end)
+            AppendWay(pb, roads[features[end]].way, frame);
+        frame.road_paths[type].emplace(pb);
+        pb.clear();
+        pb.matrix(frame.matrix);
+    }
+}
+
+io2d::interpreted_path Render::FeaturePath(Layer layer, int feature, const Frame &frame) const
+{
+    switch (layer)
+    {
+    case Landuses:
+        return PathFromMP(m_Model.Landuses()[feature], frame);
+    case Leisures:
+        return PathFromMP(m_Model.Leisures()[feature], frame);
+    case Waters:
+        return PathFromMP(m_Model.Waters()[feature], frame);
+    case Railways:
+        return PathFromWay(m_Model.Railways()[feature].way, frame);
+    case Roads:
+        return PathFromWay(m_Model.Roads()[feature].way, frame);
+    case Buildings:
+        return PathFromMP(m_Model.Buildings()[feature], frame);
+    default:
+        return {};
+    }
+}
+
+// The number of vertices of a feature's geometry at a GeometryLevels level.
+size_t Render::FeatureVertices(Layer layer, int feature, int level) const
+{
+    auto mp_vertices = [&](const Model::Multipolygon &mp)
+    {
+        size_t vertices = 0;
+        for (auto way : mp.outer)
+            vertices += m_Geometry.WayNodes(way, level).size();
+        for (auto way : mp.inner)
+            vertices += m_Geometry.WayNodes(way, level).size();
+        return vertices;
+    };
+    switch (layer)
+    {
+    case Landuses:
+        return mp_vertices(m_Model.Landuses()[feature]);
+    case Leisures:
+        return mp_vertices(m_Model.Leisures()[feature]);
+    case Waters:
+        return mp_vertices(m_Model.Waters()[feature]);
+    case Railways:
+        return m_Geometry.WayNodes(m_Model.Railways()[feature].way, level).size();
+    case Roads:
+        return m_Geometry.WayNodes(m_Model.Roads()[feature].way, level).size();
+    case Buildings:
+        return mp_vertices(m_Model.Buildings()[feature]);
+    default:
+        return 0;
+    }
+}
+
+template <typename Surface>
+void Render::DrawPath(Surface &surface) const
+{
+    if (m_Path.Empty())
+        return;
     io2d::render_props aliased{io2d::antialias::none};
     io2d::brush foreBrush{io2d::rgba_color::orange};
     float width = 5.0f;
-    surface.stroke(foreBrush, PathLine(), std::nullopt, io2d::stroke_props{width});
+    surface.stroke(foreBrush, m_PathLine, std::nullopt, io2d::stroke_props{width});
 }
 
-void Render::DrawEndPosition(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawSearchSpace(Surface &surface) const
 {
-    if (m_Model.path.empty())
+    if (m_TraceFrontier)
+        surface.fill(m_TraceFrontierBrush, *m_TraceFrontier);
+    for (auto &[bin, path] : m_TraceBins)
+    {
+        // Early nodes are blue and late ones red, so a heuristic that pulls the search towards the target
+        // shows as a narrow band turning red along the route.
+        auto t = (bin + 0.5f) / kTraceBins;
+        io2d::brush brush{io2d::rgba_color{static_cast<int>(255 * t), 64, static_cast<int>(255 * (1.f - t)), 200}};
+        surface.fill(brush, path);
+    }
+}
+
+// io2d has no text, so the overlay is a bar chart: one row per stage in StageName order, the bar showing the
+// median and a thin tick the 95th percentile, on a translucent panel.
+template <typename Surface>
+void Render::DrawStats(Surface &surface) const
+{
+    static const io2d::rgba_color colors[StageCount] = {
+        io2d::rgba_color{176, 140, 100}, io2d::rgba_color{60, 180, 75},  io2d::rgba_color{70, 130, 200},
+        io2d::rgba_color{93, 93, 93},    io2d::rgba_color{230, 160, 40}, io2d::rgba_color{150, 110, 90},
+        io2d::rgba_color{230, 80, 50},   io2d::rgba_color{30, 30, 30}};
+    constexpr float row = 10.f, bar = 6.f, margin = 8.f;
+
+    auto longest = 0.f;
+    for (int stage = 0; stage < StageCount; ++stage)
+        longest = std::max(longest, static_cast<float>(m_StageTimes[stage].Percentile(95)) * kStatsPixelsPerMillisecond);
+    auto width = std::min(longest + 2.f * margin, static_cast<float>(surface.dimensions().x()));
+
+    auto panel = io2d::path_builder{};
+    panel.new_figure({0.f, 0.f});
+    panel.rel_line({width, 0.f});
+    panel.rel_line({0.f, StageCount * row + margin});
+    panel.rel_line({-width, 0.f});
+    panel.close_figure();
+    surface.fill(io2d::brush{io2d::rgba_color{255, 255, 255, 200}}, panel);
+
+    for (int stage = 0; stage < StageCount; ++stage)
+    {
+        auto median = static_cast<float>(m_StageTimes[stage].Percentile(50)) * kStatsPixelsPerMillisecond;
+        auto tail = static_cast<float>(m_StageTimes[stage].Percentile(95)) * kStatsPixelsPerMillisecond;
+        auto top = margin / 2.f + stage * row;
+        auto pb = io2d::path_builder{};
+        pb.new_figure({margin, top});
+        pb.rel_line({std::max(median, 1.f), 0.f});
+        pb.rel_line({0.f, bar});
+        pb.rel_line({-std::max(median, 1.f), 0.f});
+        pb.close_figure();
+        pb.new_figure({margin + tail, top});
+        pb.rel_line({1.f, 0.f});
+        pb.rel_line({0.f, bar});
+        pb.rel_line({-1.f, 0.f});
+        pb.close_figure();
+        surface.fill(io2d::brush{colors[stage]}, pb);
+    }
+}
+
+template <typename Surface>
+void Render::DrawEndPosition(Surface &surface) const
+{
+    if (m_Path.Empty())
         return;
     io2d::render_props aliased{io2d::antialias::none};
     io2d::brush foreBrush{io2d::rgba_color::red};
 
     auto pb = io2d::path_builder{};
-    pb.matrix(m_Matrix);
+    pb.matrix(m_Frame.matrix);
 
-    pb.new_figure({(float)m_Model.path.back().x, (float)m_Model.path.back().y});
+    pb.new_figure(ToPoint2D(m_Model.Nodes()[m_Path.nodes.back()]));
     float constexpr l_marker = 0.01f;
     pb.rel_line({l_marker, 0.f});
     pb.rel_line({0.f, l_marker});
@@ -61,18 +414,19 @@ void Render::DrawEndPosition(io2d::output_surface &surface) const
     surface.stroke(foreBrush, io2d::interpreted_path{pb}, std::nullopt, std::nullopt, std::nullopt, aliased);
 }
 
-void Render::DrawStartPosition(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawStartPosition(Surface &surface) const
 {
-    if (m_Model.path.empty())
+    if (m_Path.Empty())
         return;
 
     io2d::render_props aliased{io2d::antialias::none};
     io2d::brush foreBrush{io2d::rgba_color::green};
 
     auto pb = io2d::path_builder{};
-    pb.matrix(m_Matrix);
+    pb.matrix(m_Frame.matrix);
 
-    pb.new_figure({(float)m_Model.path.front().x, (float)m_Model.path.front().y});
+    pb.new_figure(ToPoint2D(m_Model.Nodes()[m_Path.nodes.front()]));
     float constexpr l_marker = 0.01f;
     pb.rel_line({l_marker, 0.f});
     pb.rel_line({0.f, l_marker});
@@ -84,123 +438,178 @@ void Render::DrawStartPosition(io2d::output_surface &surface) const
     surface.stroke(foreBrush, io2d::interpreted_path{pb}, std::nullopt, std::nullopt, std::nullopt, aliased);
 }
 
-void Render::DrawBuildings(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawBuildings(Surface &surface, const Frame &frame) const
 {
-    for (auto &building : m_Model.Buildings())
+    for (auto &path : frame.layers[Buildings].paths)
     {
-        auto path = PathFromMP(building);
         surface.fill(m_BuildingFillBrush, path);
         surface.stroke(m_BuildingOutlineBrush, path, std::nullopt, m_BuildingOutlineStrokeProps);
     }
 }
 
-void Render::DrawLeisure(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawLeisure(Surface &surface, const Frame &frame) const
 {
-    for (auto &leisure : m_Model.Leisures())
+    for (auto &path : frame.layers[Leisures].paths)
     {
-        auto path = PathFromMP(leisure);
         surface.fill(m_LeisureFillBrush, path);
         surface.stroke(m_LeisureOutlineBrush, path, std::nullopt, m_LeisureOutlineStrokeProps);
     }
 }
 
-void Render::DrawWater(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawWater(Surface &surface, const Frame &frame) const
 {
-    for (auto &water : m_Model.Waters())
-        surface.fill(m_WaterFillBrush, PathFromMP(water));
+    for (auto &path : frame.layers[Waters].paths)
+        surface.fill(m_WaterFillBrush, path);
 }
 
-void Render::DrawLanduses(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawLanduses(Surface &surface, const Frame &frame) const
 {
-    for (auto &landuse : m_Model.Landuses())
-        if (auto br = m_LanduseBrushes.find(landuse.type); br != m_LanduseBrushes.end())
-            surface.fill(br->second, PathFromMP(landuse));
+    auto &landuses = m_Model.Landuses();
+    auto &visible = frame.layers[Landuses];
+    for (size_t i = 0; i < visible.features.size(); ++i)
+        if (auto br = m_LanduseBrushes.find(landuses[visible.features[i]].type); br != m_LanduseBrushes.end())
+            surface.fill(br->second, visible.paths[i]);
 }
 
-void Render::DrawHighways(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawHighways(Surface &surface, const Frame &frame) const
 {
-    auto ways = m_Model.Ways().data();
-    for (auto road : m_Model.Roads())
-        if (auto rep_it = m_RoadReps.find(road.type); rep_it != m_RoadReps.end())
+    for (int type = 0; type < kRoadTypeCount; ++type)
+        if (frame.road_paths[type] && m_RoadReps[type])
         {
-            auto &rep = rep_it->second;
-            auto &way = ways[road.way];
-            auto width = rep.metric_width > 0.f ? (rep.metric_width * m_PixelsInMeter) : 1.f;
+            auto &rep = *m_RoadReps[type];
+            auto width = rep.metric_width > 0.f ? (rep.metric_width * frame.pixels_in_meter) : 1.f;
             auto sp = io2d::stroke_props{width, io2d::line_cap::round};
-            surface.stroke(rep.brush, PathFromWay(way), std::nullopt, sp, rep.dashes);
+            surface.stroke(rep.brush, *frame.road_paths[type], std::nullopt, sp, rep.dashes);
         }
 }
 
-void Render::DrawRailways(io2d::output_surface &surface) const
+template <typename Surface>
+void Render::DrawRailways(Surface &surface, const Frame &frame) const
 {
-    auto ways = m_Model.Ways().data();
-    for (auto &railway : m_Model.Railways())
+    for (auto &path : frame.layers[Railways].paths)
     {
-        auto &way = ways[railway.way];
-        auto path = PathFromWay(way);
-        surface.stroke(m_RailwayStrokeBrush, path, std::nullopt, io2d::stroke_props{m_RailwayOuterWidth * m_PixelsInMeter});
-        surface.stroke(m_RailwayDashBrush, path, std::nullopt, io2d::stroke_props{m_RailwayInnerWidth * m_PixelsInMeter}, m_RailwayDashes);
+        surface.stroke(m_RailwayStrokeBrush, path, std::nullopt, io2d::stroke_props{m_RailwayOuterWidth * frame.pixels_in_meter});
+        surface.stroke(m_RailwayDashBrush, path, std::nullopt, io2d::stroke_props{m_RailwayInnerWidth * frame.pixels_in_meter}, m_RailwayDashes);
+    }
+}
+
+// Builds the device-space dots of the search space overlay for the current transform. The dots keep their
+// size in pixels at every zoom, so the points are transformed here rather than by the path builder.
+void Render::BuildTracePaths()
+{
+    m_TraceBins.clear();
+    m_TraceFrontier.reset();
+    if (m_Trace.Empty())
+        return;
+
+    const auto &nodes = m_Model.Nodes();
+    auto pb = io2d::path_builder{};
+    auto add_dot = [&](int node)
+    {
+        auto center = m_Frame.matrix.transform_pt(ToPoint2D(nodes[node]));
+        pb.new_figure({center.x() - kTraceDotPixels / 2.f, center.y() - kTraceDotPixels / 2.f});
+        pb.rel_line({kTraceDotPixels, 0.f});
+        pb.rel_line({0.f, kTraceDotPixels});
+        pb.rel_line({-kTraceDotPixels, 0.f});
+        pb.close_figure();
+    };
+
+    auto &settled = m_Trace.settled;
+    for (int bin = 0; bin < kTraceBins; ++bin)
+    {
+        auto begin = settled.size() * bin / kTraceBins, end = settled.size() * (bin + 1) / kTraceBins;
+        if (begin == end)
+            continue;
+        pb.clear();
+        for (auto i = begin; i < end; ++i)
+            add_dot(settled[i]);
+        m_TraceBins.emplace_back(bin, io2d::interpreted_path{pb});
+    }
+    if (!m_Trace.frontier.empty())
+    {
+        pb.clear();
+        for (int node : m_Trace.frontier)
+            add_dot(node);
+        m_TraceFrontier.emplace(pb);
     }
 }
 
 io2d::interpreted_path Render::PathLine() const
 {
-    if (m_Model.path.empty())
+    if (m_Path.Empty())
         return {};
 
-    const auto nodes = m_Model.path;
+    const auto &nodes = m_Model.Nodes();
 
     auto pb = io2d::path_builder{};
-    pb.matrix(m_Matrix);
-    pb.new_figure(ToPoint2D(m_Model.path[0]));
+    pb.matrix(m_Frame.matrix);
+    pb.new_figure(ToPoint2D(nodes[m_Path.nodes[0]]));
 
-    for (int i = 1; i < m_Model.path.size(); i++)
-        pb.line(ToPoint2D(m_Model.path[i]));
+    for (int i = 1; i < m_Path.nodes.size(); i++)
+        pb.line(ToPoint2D(nodes[m_Path.nodes[i]]));
 
     return io2d::interpreted_path{pb};
 }
 
-io2d::interpreted_path Render::PathFromWay(const Model::Way &way) const
+io2d::interpreted_path Render::PathFromWay(int way, const Frame &frame) const
 {
-    if (way.nodes.empty())
+    if (m_Geometry.WayNodes(way, frame.level).empty())
         return {};
 
-    const auto nodes = m_Model.Nodes().data();
-
     auto pb = io2d::path_builder{};
-    pb.matrix(m_Matrix);
-    pb.new_figure(ToPoint2D(nodes[way.nodes.front()]));
-    for (auto it = ++way.nodes.begin(); it != std::end(way.nodes); ++it)
-        pb.line(ToPoint2D(nodes[*it]));
+    pb.matrix(frame.matrix);
+    AppendWay(pb, way, frame);
     return io2d::interpreted_path{pb};
 }
 
-io2d::interpreted_path Render::PathFromMP(const Model::Multipolygon &mp) const
+// Adds a way as a new open figure to a path builder whose matrix is set.
+void Render::AppendWay(io2d::path_builder &pb, int way, const Frame &frame) const
+{
+    auto way_nodes = m_Geometry.WayNodes(way, frame.level);
+    if (way_nodes.empty())
+        return;
+
+    const auto nodes = m_Model.Nodes().data();
+    pb.new_figure(ToPoint2D(nodes[*way_nodes.begin()]));
+    for (auto it = way_nodes.begin() + 1; it != way_nodes.end(); ++it)
+        pb.line(ToPoint2D(nodes[*it]));
+}
+
+io2d::interpreted_path Render::PathFromMP(const Model::Multipolygon &mp, const Frame &frame) const
 {
     const auto nodes = m_Model.Nodes().data();
-    const auto ways = m_Model.Ways().data();
 
     auto pb = io2d::path_builder{};
-    pb.matrix(m_Matrix);
+    pb.matrix(frame.matrix);
 
-    auto commit = [&](const Model::Way &way)
+    auto commit = [&](int way)
     {
-        if (way.nodes.empty())
+        auto way_nodes = m_Geometry.WayNodes(way, frame.level);
+        if (way_nodes.empty())
             return;
-        pb.new_figure(ToPoint2D(nodes[way.nodes.front()]));
-        for (auto it = ++way.nodes.begin(); it != std::end(way.nodes); ++it)
+        pb.new_figure(ToPoint2D(nodes[*way_nodes.begin()]));
+        for (auto it = way_nodes.begin() + 1; it != way_nodes.end(); ++it)
             pb.line(ToPoint2D(nodes[*it]));
         pb.close_figure();
     };
 
     for (auto way_num : mp.outer)
-        commit(ways[way_num]);
+        commit(way_num);
     for (auto way_num : mp.inner)
-        commit(ways[way_num]);
+        commit(way_num);
 
     return io2d::interpreted_path{pb};
 }
 
+template void Render::Display(io2d::output_surface &surface);
+template void Render::Display(io2d::image_surface &surface);
+template void Render::DisplayTile(io2d::image_surface &surface, int z, int x, int y) const;
+
 void Render::BuildRoadReps()
 {
     using R = Model::Road;
@@ -208,13 +617,37 @@ void Render::BuildRoadReps()
                   R::Residential, R::Service, R::Unclassified, R::Footway};
     for (auto type : types)
     {
-        auto &rep = m_RoadReps[type];
+        auto &rep = m_RoadReps[type].emplace();
         rep.brush = io2d::brush{RoadColor(type)};
         rep.metric_width = RoadMetricWidth(type);
         rep.dashes = RoadDashes(type);
     }
 }
 
+void Render::BuildFeatureIndexes()
+{
+    std::array<std::vector<BoundingBox>, LayerCount> boxes;
+    for (auto &landuse : m_Model.Landuses())
+        boxes[Landuses].push_back(m_LanduseBrushes.count(landuse.type) ? MultipolygonBounds(m_Model, landuse) : BoundingBox{});
+    for (auto &leisure : m_Model.Leisures())
+        boxes[Leisures].push_back(MultipolygonBounds(m_Model, leisure));
+    for (auto &water : m_Model.Waters())
+        boxes[Waters].push_back(MultipolygonBounds(m_Model, water));
+    for (auto &railway : m_Model.Railways())
+        boxes[Railways].push_back(WayBounds(m_Model, m_Model.Ways()[railway.way]));
+    for (auto &road : m_Model.Roads())
+        boxes[Roads].push_back(m_RoadReps[road.type] ? WayBounds(m_Model, m_Model.Ways()[road.way]) : BoundingBox{});
+    for (auto &building : m_Model.Buildings())
+        boxes[Buildings].push_back(MultipolygonBounds(m_Model, building));
+
+    for (int layer = 0; layer < LayerCount; ++layer)
+    {
+        m_StyledCounts[layer] = std::count_if(boxes[layer].begin(), boxes[layer].end(), [](const BoundingBox &box)
+                                              { return !box.Empty(); });
+        m_Indexes[layer] = FeatureIndex{std::move(boxes[layer])};
+    }
+}
+
 void Render::BuildLanduseBrushes()
 {
     m_LanduseBrushes.insert_or_assign(Model::Landuse::Commercial, io2d::brush{io2d::rgba_color{233, 195, 196}});
@@ -288,4 +721,9 @@ static io2d::dashes RoadDashes(Model::Road::Type type)
 static io2d::point_2d ToPoint2D(const Model::Node &node) noexcept
 {
     return io2d::point_2d(static_cast<float>(node.x), static_cast<float>(node.y));
-}
\ No newline at end of file
+}
+
+static double Milliseconds(std::chrono::steady_clock::duration duration) noexcept
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
@@ -1,38 +1,189 @@
 #pragma once
 
+#include <array>
 #include <unordered_map>
 #include <io2d.h>
+#include "feature_index.h"
+#include "geometry_levels.h"
+#include "rolling_percentiles.h"
 #include "route_model.h"
+#include "route_path.h"
 
 using namespace std::experimental;
 
 class Render
 {
 public:
-    Render(RouteModel &model);
-    void Display(io2d::output_surface &surface);
+    // The map layers in drawing order.
+    enum Layer
+    {
+        Landuses,
+        Leisures,
+        Waters,
+        Railways,
+        Roads,
+        Buildings,
+        LayerCount
+    };
+
+    // How many styled features of a layer were inside the view and drawn, and how many were skipped.
+    struct CullStats
+    {
+        size_t drawn = 0;
+        size_t culled = 0;
+    };
+
+    // The timed parts of Display: the map layers, then the route with its overlays, and the whole frame.
+    enum Stage
+    {
+        RouteStage = LayerCount,
+        FrameStage,
+        StageCount
+    };
+
+    // The geometry a stage handed to the surface.
+    struct Submitted
+    {
+        size_t paths = 0;
+        size_t vertices = 0;
+    };
+
+    Render(RouteModel &model, RoutePath path);
+
+    // Draws the map and the route. Works on a window (io2d::output_surface) as well as on an offscreen
+    // io2d::image_surface, so the same picture can be saved without a display.
+    template <typename Surface>
+    void Display(Surface &surface);
+
+    // Draws the map layers of tile x, y at zoom level z into the whole surface. Zoom level 0 is a single tile
+    // covering the square around the map, and every level splits each tile into four; y counts from the top.
+    // Unlike Display this changes nothing, so any number of threads may draw tiles at the same time.
+    template <typename Surface>
+    void DisplayTile(Surface &surface, int z, int x, int y) const;
+
+    // Replaces the route overlay; the cached map geometry is kept.
+    void SetPath(RoutePath path);
+    // Shows the nodes a search explored on top of the map, coloured from blue to red by settle order, with the
+    // frontier in grey. An empty trace hides the overlay.
+    void SetSearchTrace(SearchTrace trace);
+
+    // Magnifies the map by zoom >= 1 around a center given in percent of the map, like the route coordinates.
+    void SetView(float zoom, float center_x, float center_y);
+    // Shows the whole map again.
+    void ResetView();
+
+    // The culling result of the current view, per layer.
+    const std::array<CullStats, LayerCount> &Culling() const noexcept { return m_Frame.culling; }
+
+    // The time in milliseconds a stage took over the last frames in which it ran. The map layers are only drawn
+    // when the view changes, so their window holds just those frames; every other frame only runs the route.
+    const RollingPercentiles &StageTimes(int stage) const noexcept { return m_StageTimes[stage]; }
+    // What a stage submitted the last time it ran.
+    const Submitted &StageSubmitted(int stage) const noexcept { return m_StageSubmitted[stage]; }
+    static const char *StageName(int stage) noexcept;
+    // Draws the median and 95th percentile time of every stage as bars in the top left corner.
+    void ShowStats(bool show) noexcept { m_ShowStats = show; }
 
 private:
+    static constexpr int kRoadTypeCount = Model::Road::Footway + 1;
+
+    struct LayerPaths
+    {
+        std::vector<int> features;                // The visible features, in model order.
+        std::vector<io2d::interpreted_path> paths; // The path of every visible feature.
+    };
+
+    // Everything that depends on the transform. The map does not change between frames, so the device-space
+    // paths of the features in view are built once per transform and reused until it changes.
+    struct Frame
+    {
+        io2d::display_point dimensions{0, 0};
+        io2d::matrix_2d matrix;
+        float scale = 1.f;
+        float pixels_in_meter = 1.f;
+        int level = 0; // The GeometryLevels level, picked so that the error stays below half a pixel.
+        std::array<LayerPaths, LayerCount> layers;
+        // The roads are not drawn from layers[Roads].paths but stroked once per type: every visible road of a
+        // type is a figure of one path, so a frame issues one stroke call per road type instead of per road.
+        std::array<std::optional<io2d::interpreted_path>, kRoadTypeCount> road_paths;
+        std::array<CullStats, LayerCount> culling{};
+        std::array<Submitted, LayerCount> submitted{};
+    };
+
     void BuildRoadReps();
     void BuildLanduseBrushes();
+    void BuildFeatureIndexes();
+    void UpdateTransform(io2d::display_point dimensions);
+    void BuildFrame(Frame &frame) const;
+    void BuildRoadPaths(Frame &frame) const;
+    BoundingBox ViewBounds(const Frame &frame) const;
+    io2d::interpreted_path FeaturePath(Layer layer, int feature, const Frame &frame) const;
+    size_t FeatureVertices(Layer layer, int feature, int level) const;
+    Submitted RouteSubmitted() const;
 
-    void DrawBuildings(io2d::output_surface &surface) const;
-    void DrawHighways(io2d::output_surface &surface) const;
-    void DrawRailways(io2d::output_surface &surface) const;
-    void DrawLeisure(io2d::output_surface &surface) const;
-    void DrawWater(io2d::output_surface &surface) const;
-    void DrawLanduses(io2d::output_surface &surface) const;
-    void DrawStartPosition(io2d::output_surface &surface) const;
-    void DrawEndPosition(io2d::output_surface &surface) const;
-    void DrawPath(io2d::output_surface &surface) const;
-    io2d::interpreted_path PathFromWay(const Model::Way &way) const;
-    io2d::interpreted_path PathFromMP(const Model::Multipolygon &mp) const;
+    template <typename Surface>
+    void DrawMap(Surface &surface, const Frame &frame, std::array<double, LayerCount> *milliseconds = nullptr) const;
+    template <typename Surface>
+    void DrawBuildings(Surface &surface, const Frame &frame) const;
+    template <typename Surface>
+    void DrawHighways(Surface &surface, const Frame &frame) const;
+    template <typename Surface>
+    void DrawRailways(Surface &surface, const Frame &frame) const;
+    template <typename Surface>
+    void DrawLeisure(Surface &surface, const Frame &frame) const;
+    template <typename Surface>
+    void DrawWater(Surface &surface, const Frame &frame) const;
+    template <typename Surface>
+    void DrawLanduses(Surface &surface, const Frame &frame) const;
+    template <typename Surface>
+    void DrawStartPosition(Surface &surface) const;
+    template <typename Surface>
+    void DrawEndPosition(Surface &surface) const;
+    template <typename Surface>
+    void DrawPath(Surface &surface) const;
+    template <typename Surface>
+    void DrawSearchSpace(Surface &surface) const;
+    template <typename Surface>
+    void DrawStats(Surface &surface) const;
+    io2d::interpreted_path PathFromWay(int way, const Frame &frame) const;
+    void AppendWay(io2d::path_builder &pb, int way, const Frame &frame) const;
+    io2d::interpreted_path PathFromMP(const Model::Multipolygon &mp, const Frame &frame) const;
     io2d::interpreted_path PathLine() const;
+    void BuildTracePaths();
 
     RouteModel &m_Model;
-    float m_Scale = 1.f;
-    float m_PixelsInMeter = 1.f;
-    io2d::matrix_2d m_Matrix;
+    RoutePath m_Path;
+    float m_MapExtent = 1.f; // The side of the square around the map in map units, i.e. of tile 0/0/0.
+    float m_Zoom = 1.f;
+    std::optional<io2d::point_2d> m_ViewCenter; // In map units; the whole map is shown when unset.
+
+    // Simplified way geometry for every scale.
+    GeometryLevels m_Geometry;
+
+    // One R-tree per layer over the bounding boxes of its features. Features without a style get an empty
+    // box, so they are never found.
+    std::array<FeatureIndex, LayerCount> m_Indexes;
+    std::array<size_t, LayerCount> m_StyledCounts{};
+
+    Frame m_Frame;                     // The frame of Display().
+    bool m_FrameValid = false;
+    // The map layers of m_Frame rasterized once, so a frame only copies them and draws the route on top.
+    std::optional<io2d::brush> m_BaseLayer;
+    io2d::interpreted_path m_PathLine; // The route overlay, rebuilt when the path or transform changes.
+    bool m_PathLineValid = false;
+
+    // The search space overlay. Settled nodes are split by settle order into bins of one colour each, so the
+    // overlay takes one fill per bin however many nodes the search touched.
+    static constexpr int kTraceBins = 16;
+    SearchTrace m_Trace;
+    std::vector<std::pair<int, io2d::interpreted_path>> m_TraceBins; // Bin index and the dots of its nodes.
+    std::optional<io2d::interpreted_path> m_TraceFrontier;
+    bool m_TracePathsValid = false;
+    io2d::brush m_TraceFrontierBrush{io2d::rgba_color{90, 90, 90, 160}};
+
+    std::array<RollingPercentiles, StageCount> m_StageTimes;
+    std::array<Submitted, StageCount> m_StageSubmitted{};
+    bool m_ShowStats = false;
 
     io2d::brush m_BackgroundFillBrush{io2d::rgba_color{238, 235, 227}};
 
@@ -58,7 +209,7 @@ private:
         io2d::dashes dashes{};
         float metric_width = 1.f;
     };
-    std::unordered_map<Model::Road::Type, RoadRep> m_RoadReps;
+    std::array<std::optional<RoadRep>, kRoadTypeCount> m_RoadReps; // Indexed by type, unset for unstyled types.
 
     std::unordered_map<Model::Landuse::Type, io2d::brush> m_LanduseBrushes;
 };
\ No newline at end of file
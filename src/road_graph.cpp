@@ -0,0 +1,801 @@
+#include "road_graph.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr char kImageMagic[8] = {'R', 'O', 'A', 'D', 'G', 'R', 'P', 'H'};
+    constexpr std::uint32_t kImageVersion = 3;
+    constexpr std::uint32_t kImageByteOrder = 0x01020304;
+    constexpr std::uint64_t kImageAlignment = 64;
+
+    // The number of nodes or grid cells, and of roads, one thread processes at a time while building.
+    constexpr std::size_t kBuildBlock = 1024;
+    constexpr std::size_t kRoadBlock = 64;
+
+    /**
+     * The location of one array in a graph image, relative to the start of the file.
+     */
+    struct ImageSection
+    {
+        std::uint64_t offset;
+        std::uint64_t count;
+    };
+
+    /**
+     * The fixed header at the start of a graph image. All arrays are referenced by file offset, so the
+     * image is valid at whatever address it is mapped.
+     */
+    struct ImageHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order; /**< kImageByteOrder as written by the producing machine. */
+        float metric_scale;
+        float grid_min_x;
+        float grid_min_y;
+        float grid_cell;
+        std::int32_t grid_cols;
+        std::int32_t grid_rows;
+        std::int32_t component_count;
+        std::int32_t largest_component;
+        ImageSection points;
+        ImageSection offsets;
+        ImageSection edges;
+        ImageSection chains;
+        ImageSection chain_node_offsets;
+        ImageSection chain_nodes;
+        ImageSection chain_position;
+        ImageSection chain_offset;
+        ImageSection chain_edge_offsets;
+        ImageSection chain_edges;
+        ImageSection component;
+        ImageSection grid_offsets;
+        ImageSection grid_nodes;
+    };
+    static_assert(std::is_trivially_copyable_v<ImageHeader>);
+
+    /**
+     * A read-only view of a whole file. On POSIX systems the file is mapped shared, so every process that
+     * maps the same file uses the same physical pages; elsewhere it is read into memory.
+     */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+#if defined(__unix__) || defined(__APPLE__)
+        ~MappedFile()
+        {
+            if (m_Data)
+                munmap((void *)m_Data, m_Size);
+        }
+
+        bool Open(const std::string &path)
+        {
+            int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return false;
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0)
+            {
+                void *data = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+                if (data != MAP_FAILED)
+                {
+                    m_Data = (const std::byte *)data;
+                    m_Size = (std::size_t)info.st_size;
+                }
+            }
+            close(fd);
+            return m_Data != nullptr;
+        }
+#else
+        bool Open(const std::string &path)
+        {
+            std::ifstream is{path, std::ios::binary | std::ios::ate};
+            if (!is)
+                return false;
+            m_Buffer.resize((std::size_t)is.tellg());
+            is.seekg(0);
+            is.read((char *)m_Buffer.data(), m_Buffer.size());
+            m_Data = m_Buffer.data();
+            m_Size = m_Buffer.size();
+            return is && m_Size > 0;
+        }
+#endif
+
+        const std::byte *Data() const noexcept { return m_Data; }
+        std::size_t Size() const noexcept { return m_Size; }
+
+    private:
+        const std::byte *m_Data = nullptr;
+        std::size_t m_Size = 0;
+#if !(defined(__unix__) || defined(__APPLE__))
+        std::vector<std::byte> m_Buffer;
+#endif
+    };
+}
+
+/**
+ * The arrays of a graph built in memory; the graph points into them.
+ */
+struct RoadGraph::Arrays
+{
+    std::vector<Point> points;
+    std::vector<int> offsets;
+    std::vector<Edge> edges;
+    std::vector<Chain> chains;
+    std::vector<int> chain_node_offsets;
+    std::vector<int> chain_nodes;
+    std::vector<int> chain_position;
+    std::vector<float> chain_offset;
+    std::vector<int> chain_edge_offsets;
+    std::vector<ChainEdge> chain_edges;
+    std::vector<int> component;
+    std::vector<int> grid_offsets;
+    std::vector<int> grid_nodes;
+
+    std::size_t MemoryUsage() const noexcept
+    {
+        return points.capacity() * sizeof(Point) + offsets.capacity() * sizeof(int) + edges.capacity() * sizeof(Edge) +
+               chains.capacity() * sizeof(Chain) + chain_node_offsets.capacity() * sizeof(int) +
+               chain_nodes.capacity() * sizeof(int) + chain_position.capacity() * sizeof(int) +
+               chain_offset.capacity() * sizeof(float) + chain_edge_offsets.capacity() * sizeof(int) +
+               chain_edges.capacity() * sizeof(ChainEdge) + component.capacity() * sizeof(int) +
+               grid_offsets.capacity() * sizeof(int) +
+               grid_nodes.capacity() * sizeof(int);
+    }
+};
+
+/**
+ * @brief Builds the road graph of a model.
+ *
+ * Every pair of consecutive nodes on a non-footway road becomes an edge in both directions. The edges are
+ * distributed into the CSR arrays with a counting sort, then parallel edges between the same two nodes
+ * (e.g. from overlapping roads) are reduced to the shortest one. Finally the degree-2 chains are collapsed
+ * for the compressed view, the connected components are labeled, and the routable nodes are bucketed into
+ * the grid used by FindClosestNode.
+ *
+ * The per-node and per-road phases run on the thread pool. Edges are scattered into their node's range in
+ * whatever order the threads get there, but every range is sorted afterwards, so the arrays are the same
+ * for any number of threads.
+ *
+ * @param model The model to take the roads and node coordinates from.
+ * @param pool The threads to build with, nullptr to build on the calling thread.
+ * @param report Receives the time of every build phase, may be nullptr.
+ */
+RoadGraph::RoadGraph(const Model &model, ThreadPool *pool, BuildReport *report) : m_MetricScale((float)model.MetricScale())
+{
+    ThreadPool serial{1};
+    ThreadPool &threads = pool ? *pool : serial;
+    auto phase = [report](const char *name)
+    {
+        if (report)
+            report->Phase(name);
+    };
+
+    const auto &nodes = model.Nodes();
+    const auto &ways = model.Ways();
+    const auto &roads = model.Roads();
+    const std::size_t node_count = nodes.size();
+    auto arrays = std::make_shared<Arrays>();
+    auto &points = arrays->points;
+    auto &offsets = arrays->offsets;
+    auto &edges = arrays->edges;
+
+    phase("graph points");
+    points.resize(node_count);
+    threads.ParallelForBlocks(node_count, kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                              {
+        for (std::size_t i = begin; i < end; ++i)
+            points[i] = Point{(float)nodes[i].x, (float)nodes[i].y}; });
+    m_Points = points.data();
+
+    phase("graph edges");
+    // Count the edges of every node.
+    auto for_each_segment = [&](std::size_t begin, std::size_t end, auto &&visit)
+    {
+        for (std::size_t r = begin; r < end; ++r)
+        {
+            if (roads[r].type == Model::Road::Type::Footway)
+                continue;
+            const auto &way_nodes = ways[roads[r].way].nodes;
+            for (size_t i = 1; i < way_nodes.size(); ++i)
+                if (way_nodes[i - 1] != way_nodes[i])
+                    visit(way_nodes[i - 1], way_nodes[i]);
+        }
+    };
+    std::vector<std::atomic<int>> slots(node_count);
+    threads.ParallelForBlocks(roads.size(), kRoadBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                              { for_each_segment(begin, end, [&](int a, int b)
+                                                 { slots[a].fetch_add(1, std::memory_order_relaxed);
+                                                   slots[b].fetch_add(1, std::memory_order_relaxed); }); });
+
+    // Turn the counts into offsets and scatter the edges.
+    offsets.assign(node_count + 1, 0);
+    for (size_t i = 0; i < node_count; ++i)
+    {
+        offsets[i + 1] = offsets[i] + slots[i].load(std::memory_order_relaxed);
+        slots[i].store(offsets[i], std::memory_order_relaxed);
+    }
+    edges.resize(offsets.back());
+    threads.ParallelForBlocks(roads.size(), kRoadBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                              { for_each_segment(begin, end, [&](int a, int b)
+                                                 {
+        float length = Distance(a, b);
+        edges[slots[a].fetch_add(1, std::memory_order_relaxed)] = Edge{b, length};
+        edges[slots[b].fetch_add(1, std::memory_order_relaxed)] = Edge{a, length}; }); });
+
+    phase("graph csr");
+    // Sort the edges of every node and keep only the shortest edge between any two nodes.
+    std::vector<int> unique(node_count + 1, 0);
+    threads.ParallelForBlocks(node_count, kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                              {
+        for (std::size_t n = begin; n < end; ++n)
+        {
+            auto first = edges.begin() + offsets[n];
+            auto last = edges.begin() + offsets[n + 1];
+            std::sort(first, last, [](const Edge &a, const Edge &b)
+                      { return a.to != b.to ? a.to < b.to : a.length < b.length; });
+            for (auto it = first; it != last; ++it)
+                if (it == first || it->to != (it - 1)->to)
+                    ++unique[n + 1];
+        } });
+    for (std::size_t n = 0; n < node_count; ++n)
+        unique[n + 1] += unique[n];
+    std::vector<Edge> reduced(unique.back());
+    threads.ParallelForBlocks(node_count, kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                              {
+        for (std::size_t n = begin; n < end; ++n)
+        {
+            int write = unique[n];
+            for (int e = offsets[n]; e < offsets[n + 1]; ++e)
+                if (e == offsets[n] || edges[e].to != edges[e - 1].to)
+                    reduced[write++] = edges[e];
+        } });
+    offsets = std::move(unique);
+    edges = std::move(reduced);
+    slots = std::vector<std::atomic<int>>();
+
+    SetArrays(*arrays);
+    phase("graph chains");
+    BuildChains(*arrays);
+    phase("graph components");
+    BuildComponents(*arrays);
+    phase("graph snap grid");
+    BuildSnapGrid(*arrays, threads);
+    SetArrays(*arrays);
+    if (report)
+        report->Finish();
+    m_MemoryUsage = arrays->MemoryUsage();
+    m_Storage = std::move(arrays);
+}
+
+/**
+ * Points the graph at the arrays of an in-memory build.
+ *
+ * @param arrays The arrays.
+ */
+void RoadGraph::SetArrays(const Arrays &arrays)
+{
+    m_NodeCount = (int)arrays.points.size();
+    m_EdgeCount = (int)arrays.edges.size();
+    m_Points = arrays.points.data();
+    m_Offsets = arrays.offsets.data();
+    m_Edges = arrays.edges.data();
+    m_ChainCount = (int)arrays.chains.size();
+    m_ChainEdgeCount = (int)arrays.chain_edges.size();
+    m_Chains = arrays.chains.data();
+    m_ChainNodeOffsets = arrays.chain_node_offsets.data();
+    m_ChainNodes = arrays.chain_nodes.data();
+    m_ChainPosition = arrays.chain_position.data();
+    m_ChainOffset = arrays.chain_offset.data();
+    m_ChainEdgeOffsets = arrays.chain_edge_offsets.data();
+    m_ChainEdges = arrays.chain_edges.data();
+    m_Component = arrays.component.data();
+    m_GridOffsets = arrays.grid_offsets.data();
+    m_GridNodes = arrays.grid_nodes.data();
+}
+
+/**
+ * @brief Collapses the runs of degree-2 nodes into chains.
+ *
+ * Every routable node whose degree is not two is a core node. Walking from a core node along each of its
+ * edges through degree-2 nodes always ends at a core node, which yields one chain; it is recorded from the
+ * side of its lower end node only, so every chain is stored once. Rings consisting only of degree-2 nodes
+ * get their first node in index order promoted to a core node. Finally the chains that connect two
+ * different core nodes become chain edges in both directions; loops are kept in the side table but can
+ * never be part of a shortest path.
+ *
+ * @param arrays Receives the chain arrays.
+ */
+void RoadGraph::BuildChains(Arrays &arrays)
+{
+    const int node_count = NodeCount();
+    std::vector<char> core(node_count, 0);
+    for (int node = 0; node < node_count; ++node)
+        core[node] = IsRoutable(node) && m_Offsets[node + 1] - m_Offsets[node] != 2;
+
+    arrays.chain_position.assign(node_count, -1);
+    arrays.chain_offset.assign(node_count, 0.f);
+    arrays.chain_node_offsets.assign(1, 0);
+
+    std::vector<int> run;
+    std::vector<float> run_offsets;
+    auto trace_chains = [&](int start)
+    {
+        for (auto edge = EdgesBegin(start); edge != EdgesEnd(start); ++edge)
+        {
+            run.clear();
+            run_offsets.clear();
+            int previous = start, current = edge->to;
+            float length = edge->length;
+            while (!core[current])
+            {
+                run.push_back(current);
+                run_offsets.push_back(length);
+                const Edge *next = EdgesBegin(current);
+                if (next->to == previous)
+                    ++next;
+                previous = current;
+                current = next->to;
+                length += next->length;
+            }
+            if (start > current || (start == current && run.front() > run.back()))
+                continue;
+
+            for (size_t i = 0; i < run.size(); ++i)
+            {
+                arrays.chain_position[run[i]] = (int)arrays.chain_nodes.size();
+                arrays.chain_offset[run[i]] = run_offsets[i];
+                arrays.chain_nodes.push_back(run[i]);
+            }
+            arrays.chains.push_back(Chain{start, current, length});
+            arrays.chain_node_offsets.push_back((int)arrays.chain_nodes.size());
+        }
+    };
+
+    for (int node = 0; node < node_count; ++node)
+        if (core[node])
+            trace_chains(node);
+    for (int node = 0; node < node_count; ++node)
+        if (IsRoutable(node) && !core[node] && arrays.chain_position[node] < 0)
+        {
+            core[node] = 1;
+            trace_chains(node);
+        }
+
+    auto &offsets = arrays.chain_edge_offsets;
+    offsets.assign(node_count + 1, 0);
+    for (const Chain &chain : arrays.chains)
+        if (chain.from != chain.to)
+        {
+            ++offsets[chain.from + 1];
+            ++offsets[chain.to + 1];
+        }
+    for (int node = 0; node < node_count; ++node)
+        offsets[node + 1] += offsets[node];
+    arrays.chain_edges.resize(offsets.back());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (int c = 0; c < (int)arrays.chains.size(); ++c)
+    {
+        const Chain &chain = arrays.chains[c];
+        if (chain.from == chain.to)
+            continue;
+        arrays.chain_edges[fill[chain.from]++] = ChainEdge{chain.to, chain.length, c};
+        arrays.chain_edges[fill[chain.to]++] = ChainEdge{chain.from, chain.length, c};
+    }
+}
+
+/**
+ * @brief Labels the connected components of the routable nodes.
+ *
+ * Components are numbered in the order of their lowest node index by a depth-first traversal, so the
+ * labels do not depend on anything but the graph. The largest component is the one with the most nodes,
+ * the lower label winning ties.
+ *
+ * @param arrays Receives the component labels.
+ */
+void RoadGraph::BuildComponents(Arrays &arrays)
+{
+    auto &component = arrays.component;
+    component.assign(NodeCount(), -1);
+    m_ComponentCount = 0;
+    m_LargestComponent = -1;
+    int largest_size = 0;
+    std::vector<int> stack;
+    for (int root = 0; root < NodeCount(); ++root)
+    {
+        if (!IsRoutable(root) || component[root] >= 0)
+            continue;
+        int size = 0;
+        component[root] = m_ComponentCount;
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            int node = stack.back();
+            stack.pop_back();
+            ++size;
+            for (auto edge = EdgesBegin(node); edge != EdgesEnd(node); ++edge)
+                if (component[edge->to] < 0)
+                {
+                    component[edge->to] = m_ComponentCount;
+                    stack.push_back(edge->to);
+                }
+        }
+        if (size > largest_size)
+        {
+            largest_size = size;
+            m_LargestComponent = m_ComponentCount;
+        }
+        ++m_ComponentCount;
+    }
+}
+
+/**
+ * Finds the chain an interior node belongs to.
+ *
+ * @param node An interior node, i.e. one with ChainPosition(node) >= 0.
+ * @return The index of the chain.
+ */
+int RoadGraph::ChainOf(int node) const noexcept
+{
+    const int *end = m_ChainNodeOffsets + m_ChainCount + 1;
+    return (int)(std::upper_bound(m_ChainNodeOffsets, end, m_ChainPosition[node]) - m_ChainNodeOffsets) - 1;
+}
+
+/**
+ * @brief Buckets the routable nodes into a uniform grid.
+ *
+ * The grid covers the bounding box of the routable nodes with about four nodes per cell. Nodes are
+ * distributed with a counting sort and every cell is sorted afterwards, so it lists its nodes by ascending
+ * index however the threads interleave.
+ *
+ * @param arrays Receives the grid arrays.
+ * @param pool The threads to build with.
+ */
+void RoadGraph::BuildSnapGrid(Arrays &arrays, ThreadPool &pool)
+{
+    // Bounds of the routable nodes, reduced from one partial result per worker.
+    struct Bounds
+    {
+        float min_x = std::numeric_limits<float>::max(), min_y = min_x;
+        float max_x = std::numeric_limits<float>::lowest(), max_y = max_x;
+        int routable = 0;
+    };
+    std::vector<Bounds> partial(pool.Size());
+    pool.ParallelForBlocks(NodeCount(), kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned worker)
+                           {
+        Bounds &bounds = partial[worker];
+        for (int node = (int)begin; node < (int)end; ++node)
+            if (IsRoutable(node))
+            {
+                bounds.min_x = std::min(bounds.min_x, m_Points[node].x);
+                bounds.min_y = std::min(bounds.min_y, m_Points[node].y);
+                bounds.max_x = std::max(bounds.max_x, m_Points[node].x);
+                bounds.max_y = std::max(bounds.max_y, m_Points[node].y);
+                ++bounds.routable;
+            } });
+    Bounds total;
+    for (const Bounds &bounds : partial)
+    {
+        total.min_x = std::min(total.min_x, bounds.min_x);
+        total.min_y = std::min(total.min_y, bounds.min_y);
+        total.max_x = std::max(total.max_x, bounds.max_x);
+        total.max_y = std::max(total.max_y, bounds.max_y);
+        total.routable += bounds.routable;
+    }
+    m_GridMinX = total.min_x;
+    m_GridMinY = total.min_y;
+    const int routable = total.routable;
+    if (routable == 0)
+    {
+        m_GridCols = m_GridRows = 0;
+        return;
+    }
+
+    int side = std::max(1, (int)std::sqrt(routable / 4.0));
+    m_GridCell = std::max(std::max(total.max_x - m_GridMinX, total.max_y - m_GridMinY) / side, 1e-6f);
+    m_GridCols = (int)((total.max_x - m_GridMinX) / m_GridCell) + 1;
+    m_GridRows = (int)((total.max_y - m_GridMinY) / m_GridCell) + 1;
+
+    auto cell_of = [&](int node)
+    {
+        int i = std::min((int)((m_Points[node].x - m_GridMinX) / m_GridCell), m_GridCols - 1);
+        int j = std::min((int)((m_Points[node].y - m_GridMinY) / m_GridCell), m_GridRows - 1);
+        return j * m_GridCols + i;
+    };
+
+    const std::size_t cell_count = (std::size_t)m_GridCols * m_GridRows;
+    std::vector<std::atomic<int>> slots(cell_count);
+    pool.ParallelForBlocks(NodeCount(), kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                           {
+        for (int node = (int)begin; node < (int)end; ++node)
+            if (IsRoutable(node))
+                slots[cell_of(node)].fetch_add(1, std::memory_order_relaxed); });
+    auto &grid_offsets = arrays.grid_offsets;
+    grid_offsets.assign(cell_count + 1, 0);
+    for (std::size_t c = 0; c < cell_count; ++c)
+    {
+        grid_offsets[c + 1] = grid_offsets[c] + slots[c].load(std::memory_order_relaxed);
+        slots[c].store(grid_offsets[c], std::memory_order_relaxed);
+    }
+
+    // Scatter in any order, then sort every cell so that it lists its nodes by ascending index.
+    auto &grid_nodes = arrays.grid_nodes;
+    grid_nodes.resize(routable);
+    pool.ParallelForBlocks(NodeCount(), kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                           {
+        for (int node = (int)begin; node < (int)end; ++node)
+            if (IsRoutable(node))
+                grid_nodes[slots[cell_of(node)].fetch_add(1, std::memory_order_relaxed)] = node; });
+    pool.ParallelForBlocks(cell_count, kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                           {
+        for (std::size_t c = begin; c < end; ++c)
+            std::sort(grid_nodes.begin() + grid_offsets[c], grid_nodes.begin() + grid_offsets[c + 1]); });
+}
+
+/**
+ * Finds the routable node closest to the given normalized coordinates.
+ *
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param largest_component Skip the nodes outside of the largest component.
+ * @return The index of the closest node that has at least one edge, or -1 if there is none.
+ */
+int RoadGraph::FindClosestNode(float x, float y, bool largest_component) const
+{
+    if (m_GridCols == 0)
+        return -1;
+
+    float min_dist = std::numeric_limits<float>::max();
+    int closest_idx = -1;
+
+    // Distances to nodes are bounded from below by the distance to the grid, so start from the nearest cell.
+    float grid_x = std::clamp(x, m_GridMinX, m_GridMinX + m_GridCols * m_GridCell);
+    float grid_y = std::clamp(y, m_GridMinY, m_GridMinY + m_GridRows * m_GridCell);
+    float outside = (x - grid_x) * (x - grid_x) + (y - grid_y) * (y - grid_y);
+    int ci = std::min((int)((grid_x - m_GridMinX) / m_GridCell), m_GridCols - 1);
+    int cj = std::min((int)((grid_y - m_GridMinY) / m_GridCell), m_GridRows - 1);
+
+    auto scan_cell = [&](int i, int j)
+    {
+        int cell = j * m_GridCols + i;
+        for (int k = m_GridOffsets[cell]; k < m_GridOffsets[cell + 1]; ++k)
+        {
+            int node = m_GridNodes[k];
+            if (largest_component && m_Component[node] != m_LargestComponent)
+                continue;
+            float dx = m_Points[node].x - x;
+            float dy = m_Points[node].y - y;
+            float dist = dx * dx + dy * dy;
+            if (dist < min_dist || (dist == min_dist && node < closest_idx))
+            {
+                closest_idx = node;
+                min_dist = dist;
+            }
+        }
+    };
+
+    // Visit the cells ring by ring; after ring r, every unvisited node is at least r cells away.
+    int max_ring = std::max(m_GridCols, m_GridRows);
+    for (int r = 0; r <= max_ring; ++r)
+    {
+        for (int j = cj - r; j <= cj + r; ++j)
+        {
+            if (j < 0 || j >= m_GridRows)
+                continue;
+            bool edge_row = j == cj - r || j == cj + r;
+            for (int i = ci - r; i <= ci + r; i += edge_row ? 1 : 2 * r)
+            {
+                if (i >= 0 && i < m_GridCols)
+                    scan_cell(i, j);
+                if (r == 0)
+                    break;
+            }
+        }
+        float ring_dist = r * m_GridCell;
+        if (closest_idx >= 0 && min_dist < outside + ring_dist * ring_dist)
+            break;
+    }
+    return closest_idx;
+}
+
+/**
+ * Calculates the straight-line distance between two nodes.
+ *
+ * @param from The index of the first node.
+ * @param to The index of the second node.
+ * @return The distance in normalized map units.
+ */
+float RoadGraph::Distance(int from, int to) const noexcept
+{
+    return std::hypot(m_Points[from].x - m_Points[to].x, m_Points[from].y - m_Points[to].y);
+}
+
+/**
+ * @brief Writes the graph as an image file.
+ *
+ * The file starts with an ImageHeader followed by the node, edge, chain, component and grid arrays, each
+ * aligned to 64 bytes and referenced from the header by its offset. The arrays are written in the byte
+ * order of this machine; MapImage rejects images from a machine with a different byte order.
+ *
+ * @param path The file to write.
+ * @return True if the whole image was written.
+ */
+bool RoadGraph::WriteImage(const std::string &path) const
+{
+    ImageHeader header{};
+    std::memcpy(header.magic, kImageMagic, sizeof(kImageMagic));
+    header.version = kImageVersion;
+    header.byte_order = kImageByteOrder;
+    header.metric_scale = m_MetricScale;
+    header.grid_min_x = m_GridMinX;
+    header.grid_min_y = m_GridMinY;
+    header.grid_cell = m_GridCell;
+    header.grid_cols = m_GridCols;
+    header.grid_rows = m_GridRows;
+    header.component_count = m_ComponentCount;
+    header.largest_component = m_LargestComponent;
+
+    const std::uint64_t node_entries = m_NodeCount > 0 ? (std::uint64_t)m_NodeCount + 1 : 0;
+    const std::uint64_t grid_cells = m_GridCols > 0 ? (std::uint64_t)m_GridCols * m_GridRows + 1 : 0;
+    struct Block
+    {
+        ImageSection &section;
+        const void *data;
+        std::uint64_t count;
+        std::size_t element_size;
+    };
+    Block blocks[] = {
+        {header.points, m_Points, (std::uint64_t)m_NodeCount, sizeof(Point)},
+        {header.offsets, m_Offsets, node_entries, sizeof(int)},
+        {header.edges, m_Edges, (std::uint64_t)m_EdgeCount, sizeof(Edge)},
+        {header.chains, m_Chains, (std::uint64_t)m_ChainCount, sizeof(Chain)},
+        {header.chain_node_offsets, m_ChainNodeOffsets, node_entries > 0 ? (std::uint64_t)m_ChainCount + 1 : 0, sizeof(int)},
+        {header.chain_nodes, m_ChainNodes, node_entries > 0 ? (std::uint64_t)m_ChainNodeOffsets[m_ChainCount] : 0, sizeof(int)},
+        {header.chain_position, m_ChainPosition, (std::uint64_t)m_NodeCount, sizeof(int)},
+        {header.chain_offset, m_ChainOffset, (std::uint64_t)m_NodeCount, sizeof(float)},
+        {header.chain_edge_offsets, m_ChainEdgeOffsets, node_entries, sizeof(int)},
+        {header.chain_edges, m_ChainEdges, (std::uint64_t)m_ChainEdgeCount, sizeof(ChainEdge)},
+        {header.component, m_Component, (std::uint64_t)m_NodeCount, sizeof(int)},
+        {header.grid_offsets, m_GridOffsets, grid_cells, sizeof(int)},
+        {header.grid_nodes, m_GridNodes, grid_cells > 0 ? (std::uint64_t)m_GridOffsets[grid_cells - 1] : 0, sizeof(int)}};
+
+    std::uint64_t end = sizeof(ImageHeader);
+    for (Block &block : blocks)
+    {
+        end = (end + kImageAlignment - 1) / kImageAlignment * kImageAlignment;
+        block.section = ImageSection{end, block.count};
+        end += block.count * block.element_size;
+    }
+
+    std::ofstream os{path, std::ios::binary | std::ios::trunc};
+    if (!os)
+        return false;
+    os.write((const char *)&header, sizeof(header));
+    for (const Block &block : blocks)
+    {
+        static const char padding[kImageAlignment] = {};
+        os.write(padding, block.section.offset - (std::uint64_t)os.tellp());
+        os.write((const char *)block.data, block.count * block.element_size);
+    }
+    return (bool)os.flush();
+}
+
+/**
+ * @brief Checks the magic bytes of a file.
+ *
+ * @param path The file to check.
+ * @return True if the file starts with the graph image magic.
+ */
+bool RoadGraph::IsImage(const std::string &path)
+{
+    std::ifstream is{path, std::ios::binary};
+    char magic[sizeof(kImageMagic)];
+    return is.read(magic, sizeof(magic)) && std::memcmp(magic, kImageMagic, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Attaches to a graph image without copying it.
+ *
+ * The header and the array bounds are validated, but the array contents are not, so that attaching stays
+ * cheap and leaves pages untouched until a query needs them. Images are expected to come from WriteImage.
+ * The returned graph and all of its copies keep the mapping alive.
+ *
+ * @param path The image file.
+ * @return The graph, or std::nullopt if the file is not a valid image.
+ */
+std::optional<RoadGraph> RoadGraph::MapImage(const std::string &path)
+{
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path) || file->Size() < sizeof(ImageHeader))
+        return std::nullopt;
+
+    ImageHeader header;
+    std::memcpy(&header, file->Data(), sizeof(header));
+    if (std::memcmp(header.magic, kImageMagic, sizeof(kImageMagic)) != 0 || header.version != kImageVersion ||
+        header.byte_order != kImageByteOrder)
+        return std::nullopt;
+
+    const std::uint64_t size = file->Size();
+    auto valid = [&](const ImageSection &section, std::size_t element_size)
+    {
+        return section.offset % kImageAlignment == 0 && section.offset <= size &&
+               section.count <= (size - section.offset) / element_size &&
+               section.count < (std::uint64_t)std::numeric_limits<int>::max();
+    };
+    const bool has_grid = header.grid_cols > 0 && header.grid_rows > 0 && header.grid_cell > 0.f;
+    const std::uint64_t grid_cells = has_grid ? (std::uint64_t)header.grid_cols * header.grid_rows + 1 : 0;
+    const std::uint64_t node_entries = header.points.count > 0 ? header.points.count + 1 : 0;
+    if (!valid(header.points, sizeof(Point)) || !valid(header.offsets, sizeof(int)) ||
+        !valid(header.edges, sizeof(Edge)) || !valid(header.chains, sizeof(Chain)) ||
+        !valid(header.chain_node_offsets, sizeof(int)) || !valid(header.chain_nodes, sizeof(int)) ||
+        !valid(header.chain_position, sizeof(int)) || !valid(header.chain_offset, sizeof(float)) ||
+        !valid(header.chain_edge_offsets, sizeof(int)) || !valid(header.chain_edges, sizeof(ChainEdge)) ||
+        !valid(header.component, sizeof(int)) || header.component.count != header.points.count ||
+        header.largest_component < -1 || header.largest_component >= header.component_count ||
+        !valid(header.grid_offsets, sizeof(int)) || !valid(header.grid_nodes, sizeof(int)) ||
+        header.offsets.count != node_entries || header.chain_edge_offsets.count != node_entries ||
+        header.chain_position.count != header.points.count || header.chain_offset.count != header.points.count ||
+        header.chain_node_offsets.count != (node_entries > 0 ? header.chains.count + 1 : 0) ||
+        header.grid_offsets.count != grid_cells || (!has_grid && (header.grid_cols != 0 || header.grid_rows != 0)))
+        return std::nullopt;
+
+    RoadGraph graph;
+    auto at = [&](const ImageSection &section)
+    { return file->Data() + section.offset; };
+    graph.m_MetricScale = header.metric_scale;
+    graph.m_NodeCount = (int)header.points.count;
+    graph.m_EdgeCount = (int)header.edges.count;
+    graph.m_Points = (const Point *)at(header.points);
+    graph.m_Offsets = (const int *)at(header.offsets);
+    graph.m_Edges = (const Edge *)at(header.edges);
+    graph.m_ChainCount = (int)header.chains.count;
+    graph.m_ChainEdgeCount = (int)header.chain_edges.count;
+    graph.m_Chains = (const Chain *)at(header.chains);
+    graph.m_ChainNodeOffsets = (const int *)at(header.chain_node_offsets);
+    graph.m_ChainNodes = (const int *)at(header.chain_nodes);
+    graph.m_ChainPosition = (const int *)at(header.chain_position);
+    graph.m_ChainOffset = (const float *)at(header.chain_offset);
+    graph.m_ChainEdgeOffsets = (const int *)at(header.chain_edge_offsets);
+    graph.m_ChainEdges = (const ChainEdge *)at(header.chain_edges);
+    graph.m_ComponentCount = header.component_count;
+    graph.m_LargestComponent = header.largest_component;
+    graph.m_Component = (const int *)at(header.component);
+    graph.m_GridMinX = header.grid_min_x;
+    graph.m_GridMinY = header.grid_min_y;
+    graph.m_GridCell = header.grid_cell;
+    graph.m_GridCols = header.grid_cols;
+    graph.m_GridRows = header.grid_rows;
+    graph.m_GridOffsets = (const int *)at(header.grid_offsets);
+    graph.m_GridNodes = (const int *)at(header.grid_nodes);
+
+    // The offset arrays must end where the arrays they index end.
+    if (node_entries > 0 &&
+        (graph.m_Offsets[0] != 0 || graph.m_Offsets[node_entries - 1] != graph.m_EdgeCount ||
+         graph.m_ChainEdgeOffsets[0] != 0 || graph.m_ChainEdgeOffsets[node_entries - 1] != graph.m_ChainEdgeCount ||
+         graph.m_ChainNodeOffsets[0] != 0 ||
+         graph.m_ChainNodeOffsets[header.chains.count] != (int)header.chain_nodes.count))
+        return std::nullopt;
+    if (grid_cells > 0 &&
+        (graph.m_GridOffsets[0] != 0 || graph.m_GridOffsets[grid_cells - 1] != (int)header.grid_nodes.count))
+        return std::nullopt;
+
+    graph.m_MemoryUsage = file->Size();
+    graph.m_Storage = std::move(file);
+    return graph;
+}
@@ -0,0 +1,211 @@
+#ifndef ROAD_GRAPH_H
+#define ROAD_GRAPH_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "build_report.h"
+#include "model.h"
+#include "thread_pool.h"
+
+/**
+ * @class RoadGraph
+ * @brief Immutable adjacency of the routable road network.
+ *
+ * The graph is built once from a Model and stored in compressed sparse row form: the edges of node n
+ * are m_Edges[m_Offsets[n]] .. m_Edges[m_Offsets[n + 1] - 1]. Node indices are the same as in
+ * Model::Nodes(), and two nodes are connected when they are consecutive on a non-footway road.
+ * Edge lengths and coordinates use the normalized map units of the Model, so distances have to be
+ * multiplied by Model::MetricScale() to get meters.
+ *
+ * Most nodes only describe the shape of a road and have exactly two neighbors. The graph therefore also
+ * keeps a compressed view for point-to-point searches: the remaining "core" nodes are linked by chain edges
+ * whose length is that of the whole run of degree-2 nodes between them, and the interior nodes of every
+ * chain are kept in a side table so that paths can be unpacked to the full geometry.
+ *
+ * Every routable node is labeled with its connected component, so queries between different components are
+ * rejected without a search.
+ *
+ * Nothing in the graph is modified by a search, so one instance can be shared by any number of threads.
+ * The arrays live in a reference-counted storage block that copies of the graph share, either built in
+ * memory or mapped read-only from an image file written by WriteImage(). The image uses file offsets
+ * instead of pointers, so several processes that map the same file share one physical copy of the graph.
+ */
+class RoadGraph
+{
+public:
+  struct Point
+  {
+    float x = 0.f; /**< The normalized x-coordinate of the node. */
+    float y = 0.f; /**< The normalized y-coordinate of the node. */
+  };
+
+  struct Edge
+  {
+    int to;       /**< The index of the node the edge leads to. */
+    float length; /**< The length of the edge in normalized map units. */
+  };
+
+  /**
+   * A maximal run of degree-2 nodes between two core nodes.
+   */
+  struct Chain
+  {
+    int from;     /**< The core node at the start of the chain. */
+    int to;       /**< The core node at the end of the chain, equal to from for a loop. */
+    float length; /**< The length of the whole chain in normalized map units. */
+  };
+
+  /**
+   * An edge of the compressed graph, leading along a chain to the core node at its other end.
+   */
+  struct ChainEdge
+  {
+    int to;       /**< The core node the edge leads to. */
+    float length; /**< The length of the chain in normalized map units. */
+    int chain;    /**< The chain the edge runs along. */
+  };
+
+  RoadGraph() = default;
+  /**
+   * Builds the graph of a model.
+   * @param pool The threads to build with, nullptr to build on the calling thread. The result is the same
+   *             for any number of threads.
+   * @param report Receives the time of every build phase, may be nullptr.
+   */
+  RoadGraph(const Model &model, ThreadPool *pool = nullptr, BuildReport *report = nullptr);
+
+  /**
+   * Maps a graph image read-only into memory.
+   * @return The graph, or std::nullopt if the file is missing, is not a graph image or is inconsistent.
+   */
+  static std::optional<RoadGraph> MapImage(const std::string &path);
+
+  /**
+   * Checks whether a file starts like a graph image, without mapping it.
+   */
+  static bool IsImage(const std::string &path);
+
+  /**
+   * Writes the graph as a position-independent image that MapImage() can attach to.
+   * @return False if the file could not be written.
+   */
+  bool WriteImage(const std::string &path) const;
+
+  int NodeCount() const noexcept { return m_NodeCount; }
+  float MetricScale() const noexcept { return m_MetricScale; }
+  int EdgeCount() const noexcept { return m_EdgeCount; }
+  const Point &Position(int node) const noexcept { return m_Points[node]; }
+  const Edge *EdgesBegin(int node) const noexcept { return m_Edges + m_Offsets[node]; }
+  const Edge *EdgesEnd(int node) const noexcept { return m_Edges + m_Offsets[node + 1]; }
+  bool IsRoutable(int node) const noexcept { return m_Offsets[node] != m_Offsets[node + 1]; }
+
+  int ChainCount() const noexcept { return m_ChainCount; }
+  int ChainEdgeCount() const noexcept { return m_ChainEdgeCount; }
+  const Chain &GetChain(int chain) const noexcept { return m_Chains[chain]; }
+  bool IsCore(int node) const noexcept { return IsRoutable(node) && m_ChainPosition[node] < 0; }
+  const ChainEdge *ChainEdgesBegin(int node) const noexcept { return m_ChainEdges + m_ChainEdgeOffsets[node]; }
+  const ChainEdge *ChainEdgesEnd(int node) const noexcept { return m_ChainEdges + m_ChainEdgeOffsets[node + 1]; }
+
+  /**
+   * The interior nodes of all chains, each chain in order from its from node to its to node.
+   * The interior of chain c is ChainNode(ChainBegin(c)) .. ChainNode(ChainEnd(c) - 1).
+   */
+  int ChainNode(int position) const noexcept { return m_ChainNodes[position]; }
+  int ChainBegin(int chain) const noexcept { return m_ChainNodeOffsets[chain]; }
+  int ChainEnd(int chain) const noexcept { return m_ChainNodeOffsets[chain + 1]; }
+
+  /**
+   * The position of an interior node in the chain side table, -1 for core and unroutable nodes.
+   */
+  int ChainPosition(int node) const noexcept { return m_ChainPosition[node]; }
+
+  /**
+   * The distance of an interior node from the from node of its chain in normalized map units.
+   */
+  float ChainOffset(int node) const noexcept { return m_ChainOffset[node]; }
+
+  /**
+   * The chain an interior node belongs to.
+   */
+  int ChainOf(int node) const noexcept;
+
+  /**
+   * The connected component of a node, -1 for unroutable nodes.
+   */
+  int Component(int node) const noexcept { return m_Component[node]; }
+  int ComponentCount() const noexcept { return m_ComponentCount; }
+
+  /**
+   * The component with the most nodes, -1 if the graph has no routable nodes.
+   */
+  int LargestComponent() const noexcept { return m_LargestComponent; }
+
+  /**
+   * Whether a path between two routable nodes exists.
+   */
+  bool Connected(int from, int to) const noexcept { return m_Component[from] >= 0 && m_Component[from] == m_Component[to]; }
+
+  /**
+   * Finds the routable node closest to the given normalized coordinates.
+   * Ties are resolved towards the lower node index, the same as a linear scan would.
+   * @param largest_component Only consider nodes of the largest component, so that the node can reach
+   *                          as much of the map as possible.
+   * @return The node index, or -1 if the graph has no routable nodes.
+   */
+  int FindClosestNode(float x, float y, bool largest_component = false) const;
+
+  /**
+   * Straight-line distance between two nodes in normalized map units.
+   */
+  float Distance(int from, int to) const noexcept;
+
+  /**
+   * Memory held by the graph in bytes; a mapped image counts with its file size.
+   */
+  std::size_t MemoryUsage() const noexcept { return m_MemoryUsage; }
+
+private:
+  struct Arrays;
+
+  void BuildChains(Arrays &arrays);
+  void BuildComponents(Arrays &arrays);
+  void BuildSnapGrid(Arrays &arrays, ThreadPool &pool);
+  void SetArrays(const Arrays &arrays);
+
+  std::shared_ptr<const void> m_Storage; /**< Owns the memory the arrays below point into. */
+  std::size_t m_MemoryUsage = 0;
+
+  float m_MetricScale = 1.f;       /**< Meters per normalized map unit. */
+  int m_NodeCount = 0;
+  int m_EdgeCount = 0;
+  const Point *m_Points = nullptr; /**< The position of every node. */
+  const int *m_Offsets = nullptr;  /**< The first edge of every node, plus one past-the-end entry. */
+  const Edge *m_Edges = nullptr;   /**< The edges of all nodes, grouped by source node. */
+
+  int m_ChainCount = 0;
+  int m_ChainEdgeCount = 0;
+  const Chain *m_Chains = nullptr;
+  const int *m_ChainNodeOffsets = nullptr; /**< The first interior node of every chain, plus one past-the-end entry. */
+  const int *m_ChainNodes = nullptr;       /**< The interior nodes of all chains, grouped by chain. */
+  const int *m_ChainPosition = nullptr;    /**< The index in m_ChainNodes of every node, -1 if it is not interior. */
+  const float *m_ChainOffset = nullptr;    /**< The distance of every interior node from its chain's from node. */
+  const int *m_ChainEdgeOffsets = nullptr; /**< The first chain edge of every node, plus one past-the-end entry. */
+  const ChainEdge *m_ChainEdges = nullptr; /**< The chain edges of all core nodes, grouped by source node. */
+
+  int m_ComponentCount = 0;
+  int m_LargestComponent = -1;
+  const int *m_Component = nullptr; /**< The connected component of every node, -1 if it is not routable. */
+
+  // Uniform grid over the routable nodes, used to snap coordinates without scanning every node.
+  float m_GridMinX = 0.f;
+  float m_GridMinY = 0.f;
+  float m_GridCell = 1.f;
+  int m_GridCols = 0;
+  int m_GridRows = 0;
+  const int *m_GridOffsets = nullptr; /**< The first entry of every cell in m_GridNodes, plus one past-the-end entry. */
+  const int *m_GridNodes = nullptr;   /**< The routable nodes, grouped by cell and sorted by index within a cell. */
+};
+
+#endif
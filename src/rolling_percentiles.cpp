@@ -0,0 +1,54 @@
+#include "rolling_percentiles.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Creates an empty window.
+ *
+ * @param window The number of samples to keep; 0 is treated as 1.
+ */
+RollingPercentiles::RollingPercentiles(std::size_t window) : m_Samples(std::max<std::size_t>(window, 1))
+{
+}
+
+/**
+ * @brief Records a sample, replacing the oldest one if the window is full.
+ *
+ * @param sample The measured value.
+ */
+void RollingPercentiles::Add(double sample)
+{
+    m_Samples[m_Next] = sample;
+    m_Next = (m_Next + 1) % m_Samples.size();
+    m_Count = std::min(m_Count + 1, m_Samples.size());
+}
+
+/**
+ * @brief Drops all samples.
+ */
+void RollingPercentiles::Clear() noexcept
+{
+    m_Next = 0;
+    m_Count = 0;
+}
+
+/**
+ * @brief Computes a percentile of the samples in the window.
+ *
+ * Uses the nearest-rank method, so the result is always one of the samples. The window is copied and
+ * partially sorted on every call, which is cheap for the window sizes this is meant for.
+ *
+ * @param percentile The percentile in [0, 100]; values outside are clamped.
+ * @return The smallest sample that is greater than or equal to the given share of the samples, or 0 if the
+ *         window is empty.
+ */
+double RollingPercentiles::Percentile(double percentile) const
+{
+    if (m_Count == 0)
+        return 0.0;
+    std::vector<double> samples(m_Samples.begin(), m_Samples.begin() + m_Count);
+    auto rank = static_cast<std::size_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * m_Count));
+    auto nth = samples.begin() + (std::max<std::size_t>(rank, 1) - 1);
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
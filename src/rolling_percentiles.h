@@ -0,0 +1,42 @@
+#ifndef ROLLING_PERCENTILES_H
+#define ROLLING_PERCENTILES_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class RollingPercentiles
+ * @brief Percentiles over the most recent samples of a measurement, e.g. frame times.
+ *
+ * The samples live in a ring buffer of fixed size, so adding one is O(1) and the oldest sample drops out once
+ * the window is full. Percentiles are computed on demand, which suits values that are recorded every frame
+ * but only read now and then.
+ */
+class RollingPercentiles
+{
+public:
+  /**
+   * @param window The number of most recent samples to keep, at least one.
+   */
+  explicit RollingPercentiles(std::size_t window = 120);
+
+  void Add(double sample);
+  void Clear() noexcept;
+
+  std::size_t Count() const noexcept { return m_Count; }
+  std::size_t Window() const noexcept { return m_Samples.size(); }
+
+  /**
+   * Returns the nearest-rank percentile of the samples in the window.
+   * @param percentile In [0, 100]; 50 is the median and 100 the maximum.
+   * @return The percentile, or 0 if there are no samples.
+   */
+  double Percentile(double percentile) const;
+
+private:
+  std::vector<double> m_Samples; /**< The ring buffer; only the first m_Count entries are valid until it is full. */
+  std::size_t m_Next = 0;        /**< The slot the next sample is written to. */
+  std::size_t m_Count = 0;       /**< The number of valid samples. */
+};
+
+#endif
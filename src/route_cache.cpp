@@ -0,0 +1,172 @@
+#include "route_cache.h"
+#include <algorithm>
+
+// Bookkeeping per entry besides the path arrays: the list node, the hash node and the bucket pointer.
+static constexpr std::size_t kEntryOverhead = 64;
+
+/**
+ * @brief Creates an empty cache.
+ *
+ * @param max_bytes The memory budget of the whole cache.
+ * @param shards The number of shards, at least one.
+ */
+RouteCache::RouteCache(std::size_t max_bytes, unsigned shards)
+{
+    shards = std::max(1u, shards);
+    m_ShardBudget = max_bytes / shards;
+    for (unsigned i = 0; i < shards; ++i)
+        m_Shards.emplace_back(std::make_unique<Shard>());
+}
+
+/**
+ * Mixes the key fields into a hash; the shard and the bucket are both taken from it.
+ *
+ * @param key The key.
+ * @return The hash.
+ */
+std::size_t RouteCache::KeyHash::operator()(const RouteCacheKey &key) const noexcept
+{
+    std::uint64_t h = (std::uint64_t)(std::uint32_t)key.start * 0x9E3779B97F4A7C15ull;
+    h ^= ((std::uint64_t)(std::uint32_t)key.end + ((std::uint64_t)(std::uint32_t)key.profile << 32)) * 0xC2B2AE3D27D4EB4Full;
+    return (std::size_t)(h ^ (h >> 29));
+}
+
+/**
+ * @param key The key.
+ * @return The shard responsible for the key.
+ */
+RouteCache::Shard &RouteCache::ShardOf(const RouteCacheKey &key)
+{
+    return *m_Shards[(KeyHash{}(key) >> 7) % m_Shards.size()];
+}
+
+/**
+ * Brings a shard up to the generation of the caller; the shard lock must be held.
+ *
+ * @param shard The shard.
+ * @param generation The generation of the caller's graph.
+ * @return False if the caller works on an older graph than the shard, in which case it must not use it.
+ */
+bool RouteCache::SyncGeneration(Shard &shard, std::uint64_t generation)
+{
+    if (generation < shard.generation)
+        return false;
+    if (generation > shard.generation)
+    {
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+        shard.generation = generation;
+    }
+    return true;
+}
+
+/**
+ * @brief Looks up a route.
+ *
+ * @param generation The generation of the caller's graph.
+ * @param key The snapped end points.
+ * @param path Receives a copy of the cached route on a hit.
+ * @return True on a hit.
+ */
+bool RouteCache::Lookup(std::uint64_t generation, const RouteCacheKey &key, RoutePath &path)
+{
+    Shard &shard = ShardOf(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (SyncGeneration(shard, generation))
+        {
+            auto it = shard.index.find(key);
+            if (it != shard.index.end())
+            {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                path = it->second->path;
+                ++m_Hits;
+                return true;
+            }
+        }
+    }
+    ++m_Misses;
+    return false;
+}
+
+/**
+ * @brief Stores a route.
+ *
+ * An existing entry for the key is replaced. Then least recently used entries are evicted until the shard
+ * is within its budget again.
+ *
+ * @param generation The generation of the graph the route was computed on.
+ * @param key The snapped end points.
+ * @param path The route.
+ */
+void RouteCache::Insert(std::uint64_t generation, const RouteCacheKey &key, const RoutePath &path)
+{
+    const std::size_t bytes = sizeof(Entry) + kEntryOverhead + path.nodes.size() * sizeof(int) +
+                              path.distances.size() * sizeof(float);
+    if (bytes > m_ShardBudget)
+        return;
+
+    Shard &shard = ShardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!SyncGeneration(shard, generation))
+        return;
+
+    if (auto it = shard.index.find(key); it != shard.index.end())
+    {
+        shard.bytes -= it->second->bytes;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+    }
+    while (shard.bytes + bytes > m_ShardBudget)
+    {
+        shard.bytes -= shard.lru.back().bytes;
+        shard.index.erase(shard.lru.back().key);
+        shard.lru.pop_back();
+    }
+    shard.lru.push_front(Entry{key, path, bytes});
+    shard.index.emplace(key, shard.lru.begin());
+    shard.bytes += bytes;
+}
+
+/**
+ * @brief Drops all cached routes; the hit and miss counters are kept.
+ */
+void RouteCache::Clear()
+{
+    for (auto &shard : m_Shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+}
+
+/**
+ * @return The memory accounted for all cached routes in bytes.
+ */
+std::size_t RouteCache::MemoryUsage() const
+{
+    std::size_t bytes = 0;
+    for (const auto &shard : m_Shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        bytes += shard->bytes;
+    }
+    return bytes;
+}
+
+/**
+ * @return The number of cached routes.
+ */
+std::size_t RouteCache::Size() const
+{
+    std::size_t size = 0;
+    for (const auto &shard : m_Shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size += shard->lru.size();
+    }
+    return size;
+}
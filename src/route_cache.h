@@ -0,0 +1,102 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "route_path.h"
+
+/**
+ * Identifies a cached route by its snapped end points.
+ */
+struct RouteCacheKey
+{
+  int start;       /**< The snapped start node. */
+  int end;         /**< The snapped end node. */
+  int profile = 0; /**< The routing profile; all queries currently use the default profile 0. */
+
+  bool operator==(const RouteCacheKey &other) const noexcept
+  {
+    return start == other.start && end == other.end && profile == other.profile;
+  }
+};
+
+/**
+ * @class RouteCache
+ * @brief Thread-safe LRU cache of route results with a bound on its memory usage.
+ *
+ * The cache is split into shards by key hash, each with its own lock and LRU list, so concurrent
+ * connections rarely contend. Every shard may use an equal part of the byte budget and drops its least
+ * recently used routes when a new one does not fit.
+ *
+ * Results are tagged with the generation of the graph they were computed on (see RoutingEngine). The
+ * first access with a newer generation empties a shard, so a reload invalidates the cache without any
+ * coordination, and queries still running on an older graph neither read nor fill it.
+ */
+class RouteCache
+{
+public:
+  /**
+   * @param max_bytes The memory the cached routes may use in total.
+   * @param shards The number of independently locked parts.
+   */
+  explicit RouteCache(std::size_t max_bytes, unsigned shards = 16);
+
+  /**
+   * Looks up a route and marks it as recently used.
+   * @param generation The generation of the graph the caller searches.
+   * @param path Receives the cached route on a hit.
+   * @return True on a hit.
+   */
+  bool Lookup(std::uint64_t generation, const RouteCacheKey &key, RoutePath &path);
+
+  /**
+   * Stores a route, evicting the least recently used routes of its shard as needed.
+   * Routes larger than a whole shard are not cached.
+   */
+  void Insert(std::uint64_t generation, const RouteCacheKey &key, const RoutePath &path);
+
+  void Clear();
+
+  std::uint64_t Hits() const noexcept { return m_Hits; }
+  std::uint64_t Misses() const noexcept { return m_Misses; }
+  std::size_t MemoryUsage() const;
+  std::size_t Size() const;
+
+private:
+  struct Entry
+  {
+    RouteCacheKey key;
+    RoutePath path;
+    std::size_t bytes; /**< The memory accounted for this entry. */
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(const RouteCacheKey &key) const noexcept;
+  };
+
+  struct Shard
+  {
+    std::mutex mutex;
+    std::list<Entry> lru; /**< Most recently used first. */
+    std::unordered_map<RouteCacheKey, std::list<Entry>::iterator, KeyHash> index;
+    std::size_t bytes = 0;
+    std::uint64_t generation = 0; /**< The newest graph generation seen by this shard. */
+  };
+
+  Shard &ShardOf(const RouteCacheKey &key);
+  static bool SyncGeneration(Shard &shard, std::uint64_t generation);
+
+  std::size_t m_ShardBudget;
+  std::vector<std::unique_ptr<Shard>> m_Shards;
+  std::atomic<std::uint64_t> m_Hits{0};
+  std::atomic<std::uint64_t> m_Misses{0};
+};
+
+#endif
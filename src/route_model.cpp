@@ -1,49 +1,89 @@
 #include "route_model.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 
+namespace
+{
+    // The number of nodes, and of roads, one thread processes at a time while building.
+    constexpr std::size_t kBuildBlock = 1024;
+    constexpr std::size_t kRoadBlock = 64;
+}
+
 /**
  * @brief Constructor for the RouteModel class.
  *
  * This constructor initializes a RouteModel object using the provided XML data.
  * It creates RouteModel nodes based on the Model nodes and populates the m_Nodes vector.
- * It also calls the CreateNodeToRoadHashmap function to create a hashmap for efficient lookup of roads connected to each node.
+ * It also calls the CreateNodeToRoadIndex function to create an index for efficient lookup of roads connected to each node,
+ * and builds the immutable RoadGraph that is shared by the multi-threaded searches.
+ * Everything after parsing the XML runs on a thread pool and gives the same result for any number of threads.
  *
  * @param xml The XML data used to initialize the RouteModel.
+ * @param threads The number of threads to build with, 0 for one per hardware thread.
+ * @param report Receives the time of every build phase after parsing, may be nullptr.
  */
-RouteModel::RouteModel(const std::vector<std::byte> &xml) : Model(xml)
+RouteModel::RouteModel(const std::vector<std::byte> &xml, unsigned threads, BuildReport *report) : Model(xml)
 {
+    ThreadPool pool{threads};
+
     // Create RouteModel nodes.
-    int counter = 0;
-    for (Model::Node node : this->Nodes())
-    {
-        m_Nodes.emplace_back(Node(counter, this, node));
-        counter++;
-    }
-    CreateNodeToRoadHashmap();
+    if (report)
+        report->Phase("model nodes");
+    const auto &nodes = this->Nodes();
+    m_Nodes.resize(nodes.size());
+    pool.ParallelForBlocks(nodes.size(), kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                           {
+        for (std::size_t i = begin; i < end; ++i)
+            m_Nodes[i] = Node((int)i, this, nodes[i]); });
+
+    if (report)
+        report->Phase("model road index");
+    CreateNodeToRoadIndex(pool);
+    m_Graph = RoadGraph(*this, &pool, report);
 }
 
 /**
- * @brief Creates a hashmap that maps each node to the closest road in the model.
+ * @brief Creates the index of the roads that pass through each node.
  *
- * This function creates a hashmap that associates each node in the model with the closest road.
- * The hashmap is used to efficiently find the closest road to a given node during the A* search algorithm.
+ * The index is built with a counting sort in two passes over the non-footway roads: the first pass counts
+ * the roads per node and turns the counts into offsets, the second one fills in the road indices. This
+ * needs two allocations in total, so a lookup during the A* search is a plain array access. Both passes
+ * run in parallel over the roads; every node's roads are sorted afterwards, which keeps them in the order
+ * of Roads() whichever thread filled them in.
+ *
+ * @param pool The threads to build with.
  */
-void RouteModel::CreateNodeToRoadHashmap()
+void RouteModel::CreateNodeToRoadIndex(ThreadPool &pool)
 {
-    for (const Model::Road &road : Roads())
+    const auto &roads = Roads();
+    auto for_each_road_node = [&](std::size_t begin, std::size_t end, auto &&visit)
     {
-        if (road.type != Model::Road::Type::Footway)
-        {
-            for (int node_idx : Ways()[road.way].nodes)
-            {
-                if (node_to_road.find(node_idx) == node_to_road.end())
-                {
-                    node_to_road[node_idx] = std::vector<const Model::Road *>();
-                }
-                node_to_road[node_idx].push_back(&road);
-            }
-        }
+        for (std::size_t road_idx = begin; road_idx < end; ++road_idx)
+            if (roads[road_idx].type != Model::Road::Type::Footway)
+                for (int node_idx : Ways()[roads[road_idx].way].nodes)
+                    visit(node_idx, (int)road_idx);
+    };
+
+    std::vector<std::atomic<int>> slots(m_Nodes.size());
+    pool.ParallelForBlocks(roads.size(), kRoadBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                           { for_each_road_node(begin, end, [&](int node_idx, int)
+                                                { slots[node_idx].fetch_add(1, std::memory_order_relaxed); }); });
+    m_NodeRoadOffsets.assign(m_Nodes.size() + 1, 0);
+    for (std::size_t i = 0; i < m_Nodes.size(); ++i)
+    {
+        m_NodeRoadOffsets[i + 1] = m_NodeRoadOffsets[i] + slots[i].load(std::memory_order_relaxed);
+        slots[i].store(m_NodeRoadOffsets[i], std::memory_order_relaxed);
     }
+
+    m_NodeRoads.resize(m_NodeRoadOffsets.back());
+    pool.ParallelForBlocks(roads.size(), kRoadBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                           { for_each_road_node(begin, end, [&](int node_idx, int road_idx)
+                                                { m_NodeRoads[slots[node_idx].fetch_add(1, std::memory_order_relaxed)] = road_idx; }); });
+    pool.ParallelForBlocks(m_Nodes.size(), kBuildBlock, [&](std::size_t begin, std::size_t end, unsigned)
+                           {
+        for (std::size_t i = begin; i < end; ++i)
+            std::sort(m_NodeRoads.begin() + m_NodeRoadOffsets[i], m_NodeRoads.begin() + m_NodeRoadOffsets[i + 1]); });
 }
 
 /**
@@ -81,9 +121,11 @@ RouteModel::Node *RouteModel::Node::FindNeighbor(std::vector<int> node_indices)
  */
 void RouteModel::Node::FindNeighbors()
 {
-    for (auto &road : parent_model->node_to_road[this->index])
+    const auto &roads = parent_model->Roads();
+    for (int i = parent_model->m_NodeRoadOffsets[index]; i < parent_model->m_NodeRoadOffsets[index + 1]; ++i)
     {
-        RouteModel::Node *new_neighbor = this->FindNeighbor(parent_model->Ways()[road->way].nodes);
+        const Model::Road &road = roads[parent_model->m_NodeRoads[i]];
+        RouteModel::Node *new_neighbor = this->FindNeighbor(parent_model->Ways()[road.way].nodes);
         if (new_neighbor)
         {
             this->neighbors.emplace_back(new_neighbor);
@@ -125,4 +167,20 @@ RouteModel::Node &RouteModel::FindClosestNode(float x, float y)
     }
 
     return SNodes()[closest_idx];
+}
+
+/**
+ * @brief Estimates the heap memory held by the model in bytes.
+ *
+ * Adds the search nodes, the node-to-road index and the road graph to the map data of the base Model.
+ *
+ * @return The estimated size in bytes.
+ */
+std::size_t RouteModel::MemoryUsage() const noexcept
+{
+    std::size_t total = Model::MemoryUsage() + m_Graph.MemoryUsage() + m_Nodes.capacity() * sizeof(Node);
+    for (const auto &node : m_Nodes)
+        total += node.neighbors.capacity() * sizeof(Node *);
+    total += m_NodeRoadOffsets.capacity() * sizeof(int) + m_NodeRoads.capacity() * sizeof(int);
+    return total;
 }
\ No newline at end of file
@@ -3,10 +3,22 @@
 
 #include <limits>
 #include <cmath>
-#include <unordered_map>
+#include "build_report.h"
 #include "model.h"
+#include "road_graph.h"
+#include "thread_pool.h"
 #include <iostream>
 
+/**
+ * A position on the map given in percent of the map's width and height, the same convention
+ * RoutePlanner uses for its start and end coordinates.
+ */
+struct MapCoordinate
+{
+  float x = 0.f; /**< The x-coordinate in percent. */
+  float y = 0.f; /**< The y-coordinate in percent. */
+};
+
 class RouteModel : public Model
 {
 
@@ -35,7 +47,7 @@ public:
      * @param other The other node to calculate the distance to.
      * @return The Euclidean distance between the two nodes.
      */
-    float distance(Node other) const
+    float distance(const Node &other) const
     {
       return std::sqrt(std::pow((x - other.x), 2) + std::pow((y - other.y), 2));
     }
@@ -49,6 +61,11 @@ public:
      */
     Node(int idx, RouteModel *search_model, Model::Node node) : Model::Node(node), parent_model(search_model), index(idx) {}
 
+    /**
+     * The index of the node in Model::Nodes() and SNodes().
+     */
+    int Index() const noexcept { return index; }
+
   private:
     int index; /**< The index of the node. */
     /**
@@ -60,15 +77,23 @@ public:
     RouteModel *parent_model = nullptr; /**< Pointer to the parent model. */
   };
 
-  RouteModel(const std::vector<std::byte> &xml);
+  /**
+   * Parses the map and builds the search structures.
+   * @param threads The number of threads to build with, 0 for one per hardware thread.
+   * @param report Receives the time of every build phase after parsing, may be nullptr.
+   */
+  RouteModel(const std::vector<std::byte> &xml, unsigned threads = 0, BuildReport *report = nullptr);
   Node &FindClosestNode(float x, float y);
   auto &SNodes() { return m_Nodes; }
-  std::vector<Node> path;
+  const RoadGraph &Graph() const noexcept { return m_Graph; }
+  std::size_t MemoryUsage() const noexcept;
 
 private:
-  void CreateNodeToRoadHashmap();
-  std::unordered_map<int, std::vector<const Model::Road *>> node_to_road;
+  void CreateNodeToRoadIndex(ThreadPool &pool);
+  std::vector<int> m_NodeRoadOffsets; /**< Node i's roads are m_NodeRoads[m_NodeRoadOffsets[i], m_NodeRoadOffsets[i + 1]). */
+  std::vector<int> m_NodeRoads;       /**< Indices into Roads() of the non-footway roads at every node. */
   std::vector<Node> m_Nodes;
+  RoadGraph m_Graph;
 };
 
 #endif
@@ -0,0 +1,52 @@
+#ifndef ROUTE_PATH_H
+#define ROUTE_PATH_H
+
+#include <vector>
+
+/**
+ * Outcome of a point-to-point query.
+ */
+enum class RouteStatus
+{
+  Found,        /**< The path holds the shortest route. */
+  NoRoute,      /**< An end point is not on the road network. */
+  Disconnected, /**< The end points lie in different connected parts of the road network. */
+  Cancelled,    /**< The caller stopped the search before it finished. */
+};
+
+/**
+ * @brief Compact result of a point-to-point query.
+ *
+ * The path is stored as node indices into Model::Nodes() together with the road distance from the start
+ * to every node, so the result stays small and coordinates are only looked up when they are needed.
+ */
+struct RoutePath
+{
+  std::vector<int> nodes;                    /**< The nodes of the path from start to end. */
+  std::vector<float> distances;              /**< The cumulative distance in meters at every node of the path. */
+  RouteStatus status = RouteStatus::NoRoute; /**< Found, or why the path is empty. */
+
+  bool Empty() const noexcept { return nodes.empty(); }
+  float Distance() const noexcept { return distances.empty() ? 0.f : distances.back(); }
+};
+
+/**
+ * @brief Record of the nodes a point-to-point search explored, for looking at its search space.
+ *
+ * Searches fill it only when the caller passes one in, so normal queries pay nothing for it. Node indices
+ * refer to Model::Nodes(); a search on the compressed graph only records core nodes.
+ */
+struct SearchTrace
+{
+  std::vector<int> settled;  /**< The settled nodes in settle order. */
+  std::vector<int> frontier; /**< The nodes that were queued but not settled when the search stopped. */
+
+  void Clear() noexcept
+  {
+    settled.clear();
+    frontier.clear();
+  }
+  bool Empty() const noexcept { return settled.empty() && frontier.empty(); }
+};
+
+#endif
@@ -92,44 +92,73 @@ RouteModel::Node *RoutePlanner::NextNode()
 }
 
 /**
- * @brief Represents a vector of RouteModel::Node objects.
+ * @brief Builds the path from the start node to the given node by following the parent pointers.
  *
- * This vector is used to store the nodes that make up the final path in the route planner.
- * Each element in the vector represents a node in the path.
+ * The path holds only node indices and the cumulative distance in meters at every node, so no node
+ * objects are copied. The total distance is also stored for GetDistance().
+ *
+ * @param current_node The last node of the path.
+ * @return The path from the start node to current_node.
  */
-std::vector<RouteModel::Node> RoutePlanner::ConstructFinalPath(RouteModel::Node *current_node)
+RoutePath RoutePlanner::ConstructFinalPath(RouteModel::Node *current_node)
 {
-    // Create path_found vector
+    // Create path_found
     distance = 0.0f;
-    std::vector<RouteModel::Node> path_found;
-    // For each node in the chain, add the distance from the node to its parent to the distance variable
+    RoutePath path_found;
+    // For each node in the chain, record it with the length of the step from its parent, and add that length to the distance
     while (current_node != start_node)
     {
-        path_found.push_back(*current_node);
-        distance += current_node->distance(*(current_node->parent));
+        float step = current_node->distance(*(current_node->parent));
+        path_found.nodes.push_back(current_node->Index());
+        path_found.distances.push_back(step);
+        distance += step;
         current_node = current_node->parent;
     }
 
-    // Add the start node to the path_found vector
-    path_found.push_back(*start_node);
+    // Add the start node to path_found
+    path_found.nodes.push_back(start_node->Index());
+    path_found.distances.push_back(0.0f);
 
-    // Reverse the path_found vector
-    std::reverse(path_found.begin(), path_found.end());
+    // Reverse path_found so that it runs from the start, and turn the step lengths into cumulative meters
+    std::reverse(path_found.nodes.begin(), path_found.nodes.end());
+    std::reverse(path_found.distances.begin(), path_found.distances.end());
+    float cumulative = 0.0f;
+    for (float &d : path_found.distances)
+    {
+        cumulative += d;
+        d = cumulative * m_Model.MetricScale();
+    }
 
     // Multiply the distance by the scale of the map to get meters
     distance *= m_Model.MetricScale();
+    path_found.status = RouteStatus::Found;
 
-    // Return the path_found vector
+    // Return path_found
     return path_found;
 }
 
 /**
  * Performs the A* search algorithm to find the shortest path from the start node to the end node.
+ * If the two nodes lie in different connected components of the road graph, the search is skipped and the
+ * path gets the status RouteStatus::Disconnected, leaving the model untouched.
+ *
+ * @param trace If not null, receives the nodes in the order they were taken from the open list, and the
+ *              nodes still on the open list when the search stopped.
  */
-void RoutePlanner::AStarSearch()
+void RoutePlanner::AStarSearch(SearchTrace *trace)
 {
     RouteModel::Node *current_node = nullptr;
 
+    // Reject queries that cannot succeed before touching any node
+    m_Path = RoutePath{};
+    if (trace)
+        trace->Clear();
+    if (start_node != end_node && !m_Model.Graph().Connected(start_node->Index(), end_node->Index()))
+    {
+        m_Path.status = RouteStatus::Disconnected;
+        return;
+    }
+
     // Set the start node's visited attribute to true
     start_node->visited = true;
 
@@ -140,16 +169,22 @@ void RoutePlanner::AStarSearch()
     {
         // Get the next node from the open_list
         current_node = NextNode();
+        if (trace)
+            trace->settled.push_back(current_node->Index());
 
         // Check if the current node is the end node
         if (current_node == end_node)
         {
             // Construct the final path
-            m_Model.path = ConstructFinalPath(current_node);
-            return;
+            m_Path = ConstructFinalPath(current_node);
+            break;
         }
 
         // Add all of the neighbors of the current node to the open_list
         AddNeighbors(current_node);
     }
+
+    if (trace)
+        for (auto node : open_list)
+            trace->frontier.push_back(node->Index());
 }
\ No newline at end of file
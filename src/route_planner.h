@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include "route_model.h"
+#include "route_path.h"
 
 /**
  * @class RoutePlanner
@@ -13,7 +14,8 @@
  * The RoutePlanner class uses the A* search algorithm to find the shortest path between a start and end point
  * on a given map. It takes a RouteModel object, start and end coordinates as input, and provides methods to
  * calculate the distance, perform the A* search, add neighbors to a node, calculate the heuristic value,
- * construct the final path, and find the next node in the search.
+ * construct the final path, and find the next node in the search. The found path is kept by the planner as
+ * node indices and cumulative distances; coordinates are looked up in the model only when needed.
  */
 class RoutePlanner
 {
@@ -21,12 +23,13 @@ public:
   RoutePlanner(RouteModel &model, float start_x, float start_y, float end_x, float end_y);
   // Add public variables or methods declarations here.
   float GetDistance() const { return distance; }
-  void AStarSearch();
+  const RoutePath &Path() const noexcept { return m_Path; }
+  void AStarSearch(SearchTrace *trace = nullptr);
 
   // The following methods have been made public, so we can test them individually.
   void AddNeighbors(RouteModel::Node *current_node);
   float CalculateHValue(RouteModel::Node const *node);
-  std::vector<RouteModel::Node> ConstructFinalPath(RouteModel::Node *);
+  RoutePath ConstructFinalPath(RouteModel::Node *);
   RouteModel::Node *NextNode();
 
 private:
@@ -36,6 +39,7 @@ private:
   RouteModel::Node *end_node;
 
   float distance = 0.0f;
+  RoutePath m_Path;
   RouteModel &m_Model;
 };
 
@@ -0,0 +1,111 @@
+#include "route_query_worker.h"
+#include <chrono>
+#include "graph_search.h"
+
+/**
+ * @brief Starts the worker thread, which sleeps until the first query is submitted.
+ *
+ * @param graph The graph to search.
+ */
+RouteQueryWorker::RouteQueryWorker(const RoadGraph &graph) : m_Graph(graph)
+{
+    m_Thread = std::thread{&RouteQueryWorker::Run, this};
+}
+
+/**
+ * @brief Cancels the running query and joins the worker thread.
+ */
+RouteQueryWorker::~RouteQueryWorker()
+{
+    {
+        std::lock_guard lock{m_Mutex};
+        m_Stop = true;
+        m_Cancel = true;
+    }
+    m_Wake.notify_one();
+    m_Thread.join();
+    delete m_Result.exchange(nullptr);
+}
+
+/**
+ * @brief Queues a query and makes every older one stale.
+ *
+ * A request that is still waiting is replaced, and a running search is told to stop. Both happen under the
+ * mutex the worker takes a request under, so a search is only ever cancelled by a request newer than itself.
+ *
+ * @param start_x The x coordinate of the start in percent of the map.
+ * @param start_y The y coordinate of the start in percent of the map.
+ * @param end_x The x coordinate of the end in percent of the map.
+ * @param end_y The y coordinate of the end in percent of the map.
+ * @return The id of the query.
+ */
+std::uint64_t RouteQueryWorker::Submit(float start_x, float start_y, float end_x, float end_y)
+{
+    std::uint64_t id;
+    {
+        std::lock_guard lock{m_Mutex};
+        id = ++m_NextId;
+        if (m_Pending)
+            ++m_Cancelled;
+        if (m_Running)
+            m_Cancel = true;
+        m_Pending = Request{id, start_x, start_y, end_x, end_y};
+    }
+    m_Wake.notify_one();
+    return id;
+}
+
+/**
+ * @brief Takes the result slot.
+ *
+ * @return The newest finished result, or std::nullopt if none has finished since the last call.
+ */
+std::optional<RouteQueryWorker::Result> RouteQueryWorker::TakeResult()
+{
+    std::unique_ptr<Result> result{m_Result.exchange(nullptr, std::memory_order_acquire)};
+    if (!result)
+        return std::nullopt;
+    return std::move(*result);
+}
+
+/**
+ * @brief The worker loop: takes the newest request, runs it and publishes the result unless it went stale.
+ *
+ * The workspace is kept across queries, so after the first one a query allocates nothing but its result.
+ */
+void RouteQueryWorker::Run()
+{
+    SearchWorkspace workspace;
+    while (true)
+    {
+        Request request;
+        {
+            std::unique_lock lock{m_Mutex};
+            m_Running = false;
+            m_Wake.wait(lock, [this] { return m_Stop || m_Pending; });
+            if (m_Stop)
+                return;
+            request = *m_Pending;
+            m_Pending.reset();
+            m_Running = true;
+            m_Cancel = false;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = std::make_unique<Result>();
+        result->id = request.id;
+        int source = m_Graph.FindClosestNode(request.start_x * 0.01f, request.start_y * 0.01f);
+        int target = m_Graph.FindClosestNode(request.end_x * 0.01f, request.end_y * 0.01f);
+        FindShortestPath(m_Graph, source, target, workspace, result->path, nullptr, &m_Cancel);
+        result->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // A cancelled search has nothing worth showing, and a newer request is already waiting.
+        if (result->path.status == RouteStatus::Cancelled)
+        {
+            ++m_Cancelled;
+            continue;
+        }
+        // Replace a result the drawing thread has not taken yet; it is older than this one.
+        delete m_Result.exchange(result.release(), std::memory_order_acq_rel);
+    }
+}
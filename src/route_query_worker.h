@@ -0,0 +1,86 @@
+#ifndef ROUTE_QUERY_WORKER_H
+#define ROUTE_QUERY_WORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "road_graph.h"
+#include "route_path.h"
+
+/**
+ * @class RouteQueryWorker
+ * @brief Runs point-to-point queries on a background thread for an interactive viewer.
+ *
+ * Only the newest query matters to a user who keeps picking new end points, so there is a single request
+ * slot: Submit() replaces a request that has not started yet and cancels the one that is running. Finished
+ * results are published through a single atomic slot, which the drawing thread polls with TakeResult() once
+ * per frame without ever blocking on the search.
+ */
+class RouteQueryWorker
+{
+public:
+  /**
+   * A finished query.
+   */
+  struct Result
+  {
+    std::uint64_t id = 0;      /**< The id Submit() returned for the query. */
+    RoutePath path;            /**< The route, empty with the status telling why if there is none. */
+    double milliseconds = 0.0; /**< The time the search took on the worker thread. */
+  };
+
+  /**
+   * Starts the worker thread.
+   * @param graph The graph to search. It must outlive the worker and must not change while it runs.
+   */
+  explicit RouteQueryWorker(const RoadGraph &graph);
+  ~RouteQueryWorker();
+
+  RouteQueryWorker(const RouteQueryWorker &) = delete;
+  RouteQueryWorker &operator=(const RouteQueryWorker &) = delete;
+
+  /**
+   * Queues a query between two points given in percent of the map, replacing any query that has not finished.
+   * @return The id of the query, increasing with every call.
+   */
+  std::uint64_t Submit(float start_x, float start_y, float end_x, float end_y);
+
+  /**
+   * Takes the newest finished result, if there is one that has not been taken yet. Never blocks.
+   */
+  std::optional<Result> TakeResult();
+
+  /**
+   * Number of queries that were dropped: replaced while waiting, or stopped while running.
+   */
+  std::uint64_t Cancelled() const noexcept { return m_Cancelled; }
+
+private:
+  struct Request
+  {
+    std::uint64_t id;
+    float start_x, start_y, end_x, end_y;
+  };
+
+  void Run();
+
+  const RoadGraph &m_Graph;
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Wake;
+  std::optional<Request> m_Pending; /**< The request slot, guarded by m_Mutex. */
+  bool m_Running = false;           /**< A search is in progress, guarded by m_Mutex. */
+  bool m_Stop = false;
+  std::uint64_t m_NextId = 0;
+  std::atomic<bool> m_Cancel{false};       /**< Set to stop the running search. */
+  std::atomic<std::uint64_t> m_Cancelled{0};
+
+  std::atomic<Result *> m_Result{nullptr}; /**< The result slot, owned by whoever swaps it out. */
+  std::thread m_Thread;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "route_request.h"
+
+/**
+ * Reads an [x, y] coordinate pair from a request member.
+ *
+ * @param request The request object.
+ * @param key The name of the member.
+ * @param coordinate Receives the coordinates.
+ * @return True if the member exists and holds two numbers.
+ */
+static bool ReadCoordinate(const JsonValue &request, std::string_view key, MapCoordinate &coordinate)
+{
+    const JsonValue *value = request.Find(key);
+    if (!value || !value->IsArray() || value->array.size() != 2 ||
+        !value->array[0].IsNumber() || !value->array[1].IsNumber())
+        return false;
+    coordinate.x = (float)value->array[0].number;
+    coordinate.y = (float)value->array[1].number;
+    return true;
+}
+
+/**
+ * @brief Parses one request line.
+ *
+ * @param line The JSON text of the request.
+ * @param request Receives the id and the coordinates.
+ * @param error Receives a description of the problem on failure.
+ * @return True if the line is a valid request.
+ */
+bool ParseRouteRequest(std::string_view line, RouteRequest &request, std::string &error)
+{
+    auto json = ParseJson(line);
+    if (!json || !json->IsObject())
+    {
+        error = "request is not a JSON object";
+        return false;
+    }
+
+    request.id = JsonValue{};
+    if (const JsonValue *id = json->Find("id"))
+        request.id = *id;
+
+    if (!ReadCoordinate(*json, "start", request.query.start) || !ReadCoordinate(*json, "end", request.query.end))
+    {
+        error = "\"start\" and \"end\" must be [x, y] arrays of numbers";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the response line for a routed request.
+ *
+ * @param os The stream to write to.
+ * @param id The id of the request.
+ * @param path The result of the query.
+ * @param graph The graph the path refers to, used to resolve node coordinates.
+ */
+void WriteRouteResponse(std::ostream &os, const JsonValue &id, const RoutePath &path, const RoadGraph &graph)
+{
+    if (path.Empty())
+    {
+        WriteRouteError(os, id, path.status == RouteStatus::Disconnected ? "start and end are not connected" : "no route");
+        return;
+    }
+
+    os << "{\"id\":";
+    WriteJson(os, id);
+    os << ",\"distance\":" << path.Distance() << ",\"path\":[";
+    for (size_t i = 0; i < path.nodes.size(); ++i)
+    {
+        const auto &p = graph.Position(path.nodes[i]);
+        os << (i > 0 ? ",[" : "[") << p.x * 100.f << ',' << p.y * 100.f << ']';
+    }
+    os << "]}\n";
+}
+
+/**
+ * @brief Writes an error response line.
+ *
+ * @param os The stream to write to.
+ * @param id The id of the request, null if it could not be parsed.
+ * @param error The error message.
+ */
+void WriteRouteError(std::ostream &os, const JsonValue &id, std::string_view error)
+{
+    os << "{\"id\":";
+    WriteJson(os, id);
+    os << ",\"error\":";
+    WriteJsonString(os, error);
+    os << "}\n";
+}
@@ -0,0 +1,45 @@
+#ifndef ROUTE_REQUEST_H
+#define ROUTE_REQUEST_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "batch_router.h"
+#include "json.h"
+#include "road_graph.h"
+#include "route_path.h"
+
+/**
+ * @brief One route request of the line-based JSON protocol.
+ *
+ * A request is a single JSON object such as {"id": 7, "start": [10, 10], "end": [90, 90]}, with the
+ * coordinates in percent as accepted by RoutePlanner. The id is optional and may be any JSON value;
+ * it is echoed back unchanged in the response.
+ */
+struct RouteRequest
+{
+  JsonValue id;     /**< The caller's id of the request, null if none was given. */
+  RouteQuery query; /**< The start and end coordinates. */
+};
+
+/**
+ * Parses one request line.
+ * @param line The JSON text of the request.
+ * @param request Receives the request.
+ * @param error Receives a description of the problem if the line is not a valid request.
+ * @return True on success.
+ */
+bool ParseRouteRequest(std::string_view line, RouteRequest &request, std::string &error);
+
+/**
+ * Writes the response line for a routed request: {"id":..,"distance":..,"path":[[x,y],..]}
+ * with the distance in meters and the path coordinates in percent, or an error if the path is empty.
+ */
+void WriteRouteResponse(std::ostream &os, const JsonValue &id, const RoutePath &path, const RoadGraph &graph);
+
+/**
+ * Writes an error response line: {"id":..,"error":"..."}.
+ */
+void WriteRouteError(std::ostream &os, const JsonValue &id, std::string_view error);
+
+#endif
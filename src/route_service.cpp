@@ -0,0 +1,50 @@
+#include "route_service.h"
+#include <sstream>
+#include "route_request.h"
+
+/**
+ * @brief Answers one request line.
+ *
+ * Parses the request, pins the current graph, snaps both coordinates, runs an A* search unless the cache
+ * already has the route, and formats the result. Invalid requests and unreachable destinations are answered
+ * with an error line, never with an exception.
+ *
+ * @param line The JSON request.
+ * @param workspace The scratch memory of the calling connection.
+ * @return The response line.
+ */
+std::string RouteService::Handle(std::string_view line, SearchWorkspace &workspace) const
+{
+    std::ostringstream response;
+    response.precision(7);
+
+    RouteRequest request;
+    std::string error;
+    if (!ParseRouteRequest(line, request, error))
+    {
+        WriteRouteError(response, request.id, error);
+        return response.str();
+    }
+
+    std::uint64_t generation;
+    auto pinned = m_Engine.Acquire(generation);
+    if (!pinned)
+    {
+        WriteRouteError(response, request.id, "no map loaded");
+        return response.str();
+    }
+
+    const RoadGraph &graph = *pinned;
+    int start = graph.FindClosestNode(request.query.start.x * 0.01f, request.query.start.y * 0.01f, m_LargestComponent);
+    int end = graph.FindClosestNode(request.query.end.x * 0.01f, request.query.end.y * 0.01f, m_LargestComponent);
+    RoutePath path;
+    RouteCacheKey key{start, end};
+    if (!m_Cache || !m_Cache->Lookup(generation, key, path))
+    {
+        FindShortestPath(graph, start, end, workspace, path);
+        if (m_Cache)
+            m_Cache->Insert(generation, key, path);
+    }
+    WriteRouteResponse(response, request.id, path, graph);
+    return response.str();
+}
@@ -0,0 +1,45 @@
+#ifndef ROUTE_SERVICE_H
+#define ROUTE_SERVICE_H
+
+#include <string>
+#include <string_view>
+#include "graph_search.h"
+#include "route_cache.h"
+#include "routing_engine.h"
+
+/**
+ * @class RouteService
+ * @brief Answers single route requests of the line-based JSON protocol against a resident graph.
+ *
+ * The service only reads the graph, so any number of connections may call Handle at the same time as long
+ * as each brings its own SearchWorkspace. Every request pins the engine's current graph, so a reload
+ * never changes the graph under a running query.
+ *
+ * With a RouteCache, routes between the same snapped end points are searched only once per loaded graph.
+ */
+class RouteService
+{
+public:
+  /**
+   * @param engine The engine providing the graph.
+   * @param cache The optional route cache; it has to outlive the service.
+   * @param largest_component Snap the request coordinates to the largest connected part of the road network.
+   */
+  RouteService(const RoutingEngine &engine, RouteCache *cache = nullptr, bool largest_component = false)
+      : m_Engine(engine), m_Cache(cache), m_LargestComponent(largest_component) {}
+
+  /**
+   * Answers one request line, see RouteRequest for the format.
+   * @param line The JSON request without the trailing newline.
+   * @param workspace The scratch memory of the calling connection.
+   * @return The response line including its trailing newline.
+   */
+  std::string Handle(std::string_view line, SearchWorkspace &workspace) const;
+
+private:
+  const RoutingEngine &m_Engine;
+  RouteCache *m_Cache;
+  bool m_LargestComponent;
+};
+
+#endif
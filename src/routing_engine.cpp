@@ -0,0 +1,164 @@
+#include "routing_engine.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include "read_file.h"
+#include "route_model.h"
+
+/**
+ * @brief Waits for a running reload before the engine goes away.
+ */
+RoutingEngine::~RoutingEngine()
+{
+    std::lock_guard<std::mutex> lock(m_ReloadMutex);
+    if (m_ReloadThread.joinable())
+        m_ReloadThread.join();
+}
+
+/**
+ * @brief Loads a map and publishes its graph.
+ *
+ * A graph image is mapped as it is. An OSM file is parsed into a RouteModel, and only the model's graph is
+ * kept; the graph shares its arrays with the model, so this copies nothing and frees the rest of the model.
+ *
+ * @param map_file The path of an OSM file or a graph image.
+ * @param report Receives the time of every load phase, may be nullptr.
+ * @param threads The number of threads to build the model with, 0 for one per hardware thread.
+ * @return True if the new graph was published.
+ */
+bool RoutingEngine::Load(const std::string &map_file, BuildReport *report, unsigned threads)
+{
+    if (RoadGraph::IsImage(map_file))
+    {
+        if (report)
+            report->Phase("map image");
+        auto graph = RoadGraph::MapImage(map_file);
+        if (report)
+            report->Finish();
+        if (!graph)
+        {
+            std::cerr << "Failed to map the graph image " << map_file << std::endl;
+            return false;
+        }
+        Publish(std::move(*graph));
+        return true;
+    }
+
+    if (report)
+        report->Phase("read file");
+    auto data = ReadFile(map_file);
+    if (!data)
+    {
+        std::cerr << "Failed to read OpenStreetMap data from " << map_file << std::endl;
+        return false;
+    }
+
+    RoadGraph graph;
+    try
+    {
+        if (report)
+            report->Phase("parse osm");
+        RouteModel model{*data, threads, report};
+        graph = model.Graph();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Failed to load " << map_file << ": " << e.what() << std::endl;
+        return false;
+    }
+    data.reset();
+
+    Publish(std::move(graph));
+    return true;
+}
+
+/**
+ * @brief Runs Load on a background thread.
+ *
+ * Unlike the initial load, a reload competes with the queries for the cores, so by default it builds on
+ * the reload thread alone and stretches the build rather than the query latency.
+ *
+ * @param map_file The path of an OSM file or a graph image.
+ * @param threads The number of threads to build with, 0 for one per hardware thread.
+ * @return True if the reload was started.
+ */
+bool RoutingEngine::ReloadAsync(const std::string &map_file, unsigned threads)
+{
+    if (m_Reloading.exchange(true))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_ReloadMutex);
+    if (m_ReloadThread.joinable())
+        m_ReloadThread.join();
+    m_ReloadThread = std::thread([this, map_file, threads]()
+                                 {
+        Load(map_file, nullptr, threads);
+        m_Reloading = false; });
+    return true;
+}
+
+/**
+ * @brief Pins the current graph and reports its generation.
+ *
+ * The returned pointer shares ownership of the whole snapshot, so the graph and the generation always
+ * belong together.
+ *
+ * @param generation Receives the generation of the graph.
+ * @return The graph, or nullptr.
+ */
+std::shared_ptr<const RoadGraph> RoutingEngine::Acquire(std::uint64_t &generation) const
+{
+    auto snapshot = std::atomic_load(&m_Snapshot);
+    if (!snapshot)
+    {
+        generation = 0;
+        return nullptr;
+    }
+    generation = snapshot->generation;
+    return std::shared_ptr<const RoadGraph>(snapshot, &snapshot->graph);
+}
+
+/**
+ * @brief Swaps in a new graph and retires the old one.
+ *
+ * The swap is a single atomic exchange, so a concurrent Acquire returns either the old or the new graph.
+ * The old graph is handed to the retired list rather than waited for, so a publisher that still pins it,
+ * or a query that holds it for long, cannot block the reload.
+ *
+ * @param graph The graph to publish.
+ */
+void RoutingEngine::Publish(RoadGraph graph)
+{
+    auto snapshot = std::make_shared<const Snapshot>(Snapshot{std::move(graph), ++m_Generation});
+    auto retired = std::atomic_exchange(&m_Snapshot, std::move(snapshot));
+    if (retired)
+    {
+        std::lock_guard<std::mutex> lock(m_RetiredMutex);
+        m_Retired.push_back(std::move(retired));
+    }
+    Reclaim();
+}
+
+/**
+ * @brief Destroys the retired graphs that are no longer pinned.
+ *
+ * A retired snapshot is not reachable through m_Snapshot any more, so once the engine holds its only
+ * reference no query can pin it again. Those snapshots are destroyed after the lock is released.
+ *
+ * @return The number of retired graphs that queries still hold.
+ */
+std::size_t RoutingEngine::Reclaim()
+{
+    std::vector<std::shared_ptr<const Snapshot>> unused;
+    std::size_t pinned;
+    {
+        std::lock_guard<std::mutex> lock(m_RetiredMutex);
+        auto still_pinned = std::partition(m_Retired.begin(), m_Retired.end(),
+                                           [](const auto &snapshot) { return snapshot.use_count() > 1; });
+        std::move(still_pinned, m_Retired.end(), std::back_inserter(unused));
+        m_Retired.erase(still_pinned, m_Retired.end());
+        pinned = m_Retired.size();
+    }
+    return pinned;
+}
@@ -0,0 +1,104 @@
+#ifndef ROUTING_ENGINE_H
+#define ROUTING_ENGINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "road_graph.h"
+
+/**
+ * @class RoutingEngine
+ * @brief Owns the current road graph and replaces it without stopping queries.
+ *
+ * Readers pin the published graph with Acquire() for the duration of one query. A reload builds the new
+ * graph off to the side and publishes it with a single atomic pointer swap, so queries never wait for the
+ * build and never see a half-built graph. Queries that pinned the old graph finish on it. The engine keeps
+ * the retired graph until no query holds it any more and destroys it in Reclaim(), which runs after every
+ * publish and should be called periodically by the owner, so the destruction never lands on a query thread
+ * and a publisher never waits for readers. Holding an Acquire() result across a Load is therefore safe; it
+ * only keeps the old graph alive a little longer.
+ *
+ * Only the RoadGraph of a loaded map is kept. It is either built from an OSM file or attached from a
+ * graph image (see RoadGraph::WriteImage), in which case all processes serving that image share its memory.
+ */
+class RoutingEngine
+{
+public:
+  RoutingEngine() = default;
+  ~RoutingEngine();
+
+  RoutingEngine(const RoutingEngine &) = delete;
+  RoutingEngine &operator=(const RoutingEngine &) = delete;
+
+  /**
+   * Builds a graph from an OSM file, or maps a graph image, on the calling thread and publishes it.
+   * @param report Receives the time of every load phase, may be nullptr.
+   * @param threads The number of threads to build with, 0 for one per hardware thread.
+   * @return False if the file could not be read or parsed; the current graph then stays in place.
+   */
+  bool Load(const std::string &map_file, BuildReport *report = nullptr, unsigned threads = 0);
+
+  /**
+   * Starts Load on a background thread.
+   * @param threads The number of threads to build with. The default of one leaves the other cores to the
+   *                queries that keep running during the reload; 0 uses one per hardware thread.
+   * @return False if a reload is already running.
+   */
+  bool ReloadAsync(const std::string &map_file, unsigned threads = 1);
+
+  bool ReloadInProgress() const noexcept { return m_Reloading; }
+
+  /**
+   * Pins the current graph. Keep the returned pointer for exactly one query.
+   * @return The graph, or nullptr if nothing has been loaded yet.
+   */
+  std::shared_ptr<const RoadGraph> Acquire() const
+  {
+    std::uint64_t generation;
+    return Acquire(generation);
+  }
+
+  /**
+   * Pins the current graph together with the generation it was published as, e.g. to tag cached results.
+   * @param generation Receives the generation of the returned graph, 0 if nothing has been loaded yet.
+   */
+  std::shared_ptr<const RoadGraph> Acquire(std::uint64_t &generation) const;
+
+  /**
+   * Number of graphs published so far; changes whenever a reload completes.
+   */
+  std::uint64_t Generation() const noexcept { return m_Generation; }
+
+  /**
+   * Destroys the retired graphs that no query holds any more.
+   * @return The number of retired graphs that are still pinned.
+   */
+  std::size_t Reclaim();
+
+private:
+  /**
+   * A published graph and its generation, swapped as one.
+   */
+  struct Snapshot
+  {
+    RoadGraph graph;
+    std::uint64_t generation;
+  };
+
+  void Publish(RoadGraph graph);
+
+  std::shared_ptr<const Snapshot> m_Snapshot; /**< Only accessed through the std::atomic_* functions. */
+  std::atomic<std::uint64_t> m_Generation{0};
+  std::atomic<bool> m_Reloading{false};
+  std::mutex m_ReloadMutex; /**< Guards m_ReloadThread. */
+  std::thread m_ReloadThread;
+  std::mutex m_RetiredMutex; /**< Guards m_Retired. */
+  std::vector<std::shared_ptr<const Snapshot>> m_Retired; /**< Replaced snapshots that may still be pinned. */
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+/**
+ * @brief Starts the background workers.
+ *
+ * @param threads The number of workers including the calling thread, 0 for one per hardware thread.
+ */
+ThreadPool::ThreadPool(unsigned threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i)
+        m_Workers.emplace_back(std::make_unique<Worker>());
+    for (unsigned i = 1; i < threads; ++i)
+        m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+/**
+ * @brief Stops and joins the background workers.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    for (auto &thread : m_Threads)
+        thread.join();
+}
+
+/**
+ * @brief Runs a task for every index of a range on all workers.
+ *
+ * @param count The number of indices.
+ * @param task The function to call with the index and the worker id.
+ */
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t, unsigned)> &task)
+{
+    if (count == 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        const std::size_t workers = m_Workers.size();
+        for (std::size_t i = 0; i < workers; ++i)
+        {
+            std::lock_guard<std::mutex> range_lock(m_Workers[i]->mutex);
+            m_Workers[i]->begin = count * i / workers;
+            m_Workers[i]->end = count * (i + 1) / workers;
+        }
+        m_Task = &task;
+        m_Running = (unsigned)m_Threads.size();
+        ++m_Round;
+    }
+    m_Wake.notify_all();
+
+    RunTasks(0);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this]
+                { return m_Running == 0; });
+    m_Task = nullptr;
+}
+
+/**
+ * @brief Runs a task for every block of a range on all workers.
+ *
+ * @param count The number of indices.
+ * @param block_size The maximum number of indices per block.
+ * @param task The function to call with the bounds of the block and the worker id.
+ */
+void ThreadPool::ParallelForBlocks(std::size_t count, std::size_t block_size,
+                                   const std::function<void(std::size_t, std::size_t, unsigned)> &task)
+{
+    block_size = std::max<std::size_t>(block_size, 1);
+    ParallelFor((count + block_size - 1) / block_size, [&](std::size_t block, unsigned worker)
+                { task(block * block_size, std::min(count, (block + 1) * block_size), worker); });
+}
+
+/**
+ * @brief Body of a background worker: waits for a round, runs it and reports back.
+ *
+ * @param id The id of the worker.
+ */
+void ThreadPool::WorkerLoop(unsigned id)
+{
+    std::size_t seen_round = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Wake.wait(lock, [&]
+                        { return m_Stop || m_Round != seen_round; });
+            if (m_Stop)
+                return;
+            seen_round = m_Round;
+        }
+
+        RunTasks(id);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            --m_Running;
+        }
+        m_Done.notify_one();
+    }
+}
+
+/**
+ * @brief Runs indices until neither the own range nor any other worker has work left.
+ *
+ * @param id The id of the worker.
+ */
+void ThreadPool::RunTasks(unsigned id)
+{
+    std::size_t index;
+    while (TakeOwn(id, index) || (Steal(id) && TakeOwn(id, index)))
+        (*m_Task)(index, id);
+}
+
+/**
+ * Takes the next index from the front of the worker's own range.
+ *
+ * @param id The id of the worker.
+ * @param index Receives the index.
+ * @return True if there was an index left.
+ */
+bool ThreadPool::TakeOwn(unsigned id, std::size_t &index)
+{
+    Worker &own = *m_Workers[id];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin >= own.end)
+        return false;
+    index = own.begin++;
+    return true;
+}
+
+/**
+ * Moves the back half of another worker's remaining range to this worker.
+ *
+ * @param id The id of the stealing worker.
+ * @return True if something was stolen.
+ */
+bool ThreadPool::Steal(unsigned id)
+{
+    const unsigned workers = Size();
+    for (unsigned k = 1; k < workers; ++k)
+    {
+        Worker &victim = *m_Workers[(id + k) % workers];
+        std::size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.begin >= victim.end)
+                continue;
+            end = victim.end;
+            begin = victim.begin + (victim.end - victim.begin) / 2;
+            victim.end = begin;
+        }
+        Worker &own = *m_Workers[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
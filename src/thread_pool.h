@@ -0,0 +1,75 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads that run index ranges with work stealing.
+ *
+ * ParallelFor splits the index range evenly over the workers. Each worker takes indices from the front of
+ * its own range; a worker that runs dry steals the back half of the range of another worker, so a few slow
+ * items do not leave the other threads idle. The calling thread takes part as worker 0, which means a pool
+ * of size 1 runs everything on the caller.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * Starts the worker threads.
+   * @param threads The total number of workers including the caller, 0 for one per hardware thread.
+   */
+  explicit ThreadPool(unsigned threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  unsigned Size() const noexcept { return (unsigned)m_Workers.size(); }
+
+  /**
+   * Calls task(index, worker) for every index in [0, count) and returns once all calls have finished.
+   * The worker argument is in [0, Size()) and identifies the thread, e.g. to pick per-thread scratch memory.
+   * The task must not throw, and only one ParallelFor may run on a pool at a time.
+   */
+  void ParallelFor(std::size_t count, const std::function<void(std::size_t, unsigned)> &task);
+
+  /**
+   * Calls task(begin, end, worker) for consecutive blocks of at most block_size indices that together cover
+   * [0, count), for loops whose body is too cheap to be scheduled one index at a time.
+   */
+  void ParallelForBlocks(std::size_t count, std::size_t block_size,
+                         const std::function<void(std::size_t, std::size_t, unsigned)> &task);
+
+private:
+  struct Worker
+  {
+    std::mutex mutex;
+    std::size_t begin = 0; /**< The next index this worker will run. */
+    std::size_t end = 0;   /**< One past the last index owned by this worker. */
+  };
+
+  void WorkerLoop(unsigned id);
+  void RunTasks(unsigned id);
+  bool TakeOwn(unsigned id, std::size_t &index);
+  bool Steal(unsigned id);
+
+  std::vector<std::unique_ptr<Worker>> m_Workers;
+  std::vector<std::thread> m_Threads;
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Wake;
+  std::condition_variable m_Done;
+  const std::function<void(std::size_t, unsigned)> *m_Task = nullptr;
+  std::size_t m_Round = 0; /**< Incremented for every ParallelFor call to wake the workers. */
+  unsigned m_Running = 0;  /**< The number of background workers still busy with the current round. */
+  bool m_Stop = false;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "tile_pyramid.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <system_error>
+#include <vector>
+#include "thread_pool.h"
+
+/**
+ * @brief Renders and saves a tile pyramid in parallel.
+ *
+ * The directories of all tiles are created up front, so the workers only render and write files. Each
+ * worker keeps one image surface for all of its tiles.
+ *
+ * @param render The renderer to draw the tiles with; it is only read.
+ * @param options The zoom levels, tile size, output directory and thread count.
+ * @return The number of tiles and the time they took.
+ */
+TilePyramidStats RenderTilePyramid(const Render &render, const TilePyramidOptions &options)
+{
+    struct Tile
+    {
+        int z, x, y;
+    };
+    const int max_zoom = (int)std::min(options.max_zoom, kMaxTileZoom);
+    std::vector<Tile> tiles;
+    for (int z = 0; z <= max_zoom; ++z)
+        for (int x = 0; x < (1 << z); ++x)
+            for (int y = 0; y < (1 << z); ++y)
+                tiles.push_back(Tile{z, x, y});
+
+    TilePyramidStats stats;
+    auto begin = std::chrono::steady_clock::now();
+    if (!options.directory.empty())
+    {
+        std::error_code error;
+        for (int z = 0; z <= max_zoom; ++z)
+            for (int x = 0; x < (1 << z); ++x)
+                std::filesystem::create_directories(std::filesystem::path{options.directory} / std::to_string(z) / std::to_string(x), error);
+    }
+
+    ThreadPool pool{options.threads};
+    std::vector<std::optional<io2d::image_surface>> surfaces(pool.Size());
+    std::vector<std::size_t> failed(pool.Size(), 0);
+    pool.ParallelFor(tiles.size(), [&](std::size_t index, unsigned worker)
+                     {
+        const Tile &tile = tiles[index];
+        auto &surface = surfaces[worker];
+        if (!surface)
+            surface.emplace(io2d::format::argb32, options.tile_size, options.tile_size);
+        render.DisplayTile(*surface, tile.z, tile.x, tile.y);
+        if (options.directory.empty())
+            return;
+        auto path = std::filesystem::path{options.directory} / std::to_string(tile.z) / std::to_string(tile.x) /
+                    (std::to_string(tile.y) + ".png");
+        std::error_code error;
+        surface->save(path, io2d::image_file_format::png, error);
+        if (error)
+            ++failed[worker]; });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    stats.tiles = tiles.size();
+    for (auto count : failed)
+        stats.failed += count;
+    stats.seconds = elapsed.count();
+    return stats;
+}
@@ -0,0 +1,44 @@
+#ifndef TILE_PYRAMID_H
+#define TILE_PYRAMID_H
+
+#include <cstddef>
+#include <string>
+#include "render.h"
+
+/**
+ * The deepest zoom level a pyramid may go to. Level z has 4^z tiles, so zoom 18 already means tens of billions
+ * of tiles in total; a tool should reject anything deeper instead of trying to allocate them.
+ */
+constexpr unsigned kMaxTileZoom = 18;
+
+/**
+ * Options of a tile pyramid run.
+ */
+struct TilePyramidOptions
+{
+  std::string directory;  /**< Tiles are written to directory/z/x/y.png; nothing is saved if empty. */
+  unsigned max_zoom = 4;  /**< Levels 0 to max_zoom are rendered; at most kMaxTileZoom. */
+  int tile_size = 256;    /**< The width and height of a tile in pixels. */
+  unsigned threads = 0;   /**< The number of rendering threads, 0 for one per hardware thread. */
+};
+
+/**
+ * Outcome of a tile pyramid run.
+ */
+struct TilePyramidStats
+{
+  std::size_t tiles = 0;  /**< The number of tiles rendered. */
+  std::size_t failed = 0; /**< The number of tiles that could not be saved. */
+  double seconds = 0.0;   /**< The wall-clock time of the whole run. */
+
+  double TilesPerSecond() const noexcept { return seconds > 0.0 ? tiles / seconds : 0.0; }
+};
+
+/**
+ * Renders the z/x/y tiles of all zoom levels up to options.max_zoom with Render::DisplayTile. The tiles are
+ * spread over a thread pool, and every thread draws into its own offscreen surface. Levels beyond
+ * kMaxTileZoom are never rendered.
+ */
+TilePyramidStats RenderTilePyramid(const Render &render, const TilePyramidOptions &options);
+
+#endif
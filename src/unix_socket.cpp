@@ -0,0 +1,142 @@
+#include "unix_socket.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Fills a socket address for a path.
+ *
+ * @param path The file system path of the socket.
+ * @param address Receives the address.
+ * @return False if the path does not fit into sockaddr_un.
+ */
+static bool MakeAddress(const std::string &path, sockaddr_un &address)
+{
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+/**
+ * @brief Creates a listening Unix domain stream socket.
+ *
+ * @param path The file system path of the socket; an existing file at that path is removed first.
+ * @param backlog The length of the queue of pending connections.
+ * @return The listening descriptor, or -1 on failure.
+ */
+int ListenUnixSocket(const std::string &path, int backlog)
+{
+    sockaddr_un address;
+    if (!MakeAddress(path, address))
+        return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    unlink(path.c_str());
+    if (bind(fd, (sockaddr *)&address, sizeof(address)) < 0 || listen(fd, backlog) < 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Connects to a Unix domain stream socket.
+ *
+ * @param path The file system path of the socket.
+ * @return The connected descriptor, or -1 on failure.
+ */
+int ConnectUnixSocket(const std::string &path)
+{
+    sockaddr_un address;
+    if (!MakeAddress(path, address))
+        return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (sockaddr *)&address, sizeof(address)) < 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Writes a whole buffer to a descriptor.
+ *
+ * @param fd The descriptor to write to.
+ * @param data The bytes to write.
+ * @return True if everything was written.
+ */
+bool WriteAll(int fd, const std::string &data)
+{
+    std::size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t n = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        written += (std::size_t)n;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the next newline-terminated frame.
+ *
+ * Data is read in blocks and kept between calls, so several requests arriving in one packet are
+ * returned one by one. With a maximum length, reading stops as soon as the unread data holds more than that
+ * without a newline, so a peer that never sends one cannot make the buffer grow without bound.
+ *
+ * @param line Receives the line without the newline.
+ * @return False at end of stream, on a read error, or if the line is too long (see LineTooLong).
+ */
+bool LineReader::ReadLine(std::string &line)
+{
+    while (true)
+    {
+        auto newline = m_Buffer.find('\n', m_Start);
+        auto length = (newline != std::string::npos ? newline : m_Buffer.size()) - m_Start;
+        if (m_MaxLength > 0 && length > m_MaxLength)
+        {
+            m_TooLong = true;
+            return false;
+        }
+        if (newline != std::string::npos)
+        {
+            line.assign(m_Buffer, m_Start, length);
+            m_Start = newline + 1;
+            return true;
+        }
+
+        // Drop the consumed prefix before reading more.
+        m_Buffer.erase(0, m_Start);
+        m_Start = 0;
+
+        char block[4096];
+        ssize_t n = read(m_Fd, block, sizeof(block));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        m_Buffer.append(block, (std::size_t)n);
+    }
+}
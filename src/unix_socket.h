@@ -0,0 +1,57 @@
+#ifndef UNIX_SOCKET_H
+#define UNIX_SOCKET_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Creates a listening Unix domain stream socket at path, replacing a stale socket file.
+ * @return The socket descriptor, or -1 on failure with errno set.
+ */
+int ListenUnixSocket(const std::string &path, int backlog);
+
+/**
+ * Connects to the Unix domain stream socket at path.
+ * @return The socket descriptor, or -1 on failure with errno set.
+ */
+int ConnectUnixSocket(const std::string &path);
+
+/**
+ * Writes the whole buffer, retrying partial writes and interrupted calls.
+ * @return False if the peer went away or an error occurred.
+ */
+bool WriteAll(int fd, const std::string &data);
+
+/**
+ * @class LineReader
+ * @brief Splits the byte stream of a socket into newline-terminated frames.
+ */
+class LineReader
+{
+public:
+  /**
+   * @param fd The descriptor to read from.
+   * @param max_length The longest line accepted, without its newline; 0 for no limit.
+   */
+  explicit LineReader(int fd, std::size_t max_length = 0) : m_Fd(fd), m_MaxLength(max_length) {}
+
+  /**
+   * Reads the next line without its newline.
+   * @return False at end of stream, on error, or once a line exceeds the maximum length.
+   */
+  bool ReadLine(std::string &line);
+
+  /**
+   * True if the last ReadLine failed because the line was longer than the maximum length.
+   */
+  bool LineTooLong() const noexcept { return m_TooLong; }
+
+private:
+  int m_Fd;
+  std::size_t m_MaxLength;
+  bool m_TooLong = false;
+  std::string m_Buffer;
+  std::size_t m_Start = 0; /**< The beginning of the unread data in m_Buffer. */
+};
+
+#endif
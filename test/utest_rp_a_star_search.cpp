@@ -116,27 +116,56 @@ TEST_F(RoutePlannerTest, TestConstructFinalPath) {
     // Construct a path.
     mid_node->parent = start_node;
     end_node->parent = mid_node;
-    std::vector<RouteModel::Node> path = route_planner.ConstructFinalPath(end_node);
+    RoutePath path = route_planner.ConstructFinalPath(end_node);
 
     // Test the path.
-    EXPECT_EQ(path.size(), 3);
-    EXPECT_FLOAT_EQ(start_node->x, path.front().x);
-    EXPECT_FLOAT_EQ(start_node->y, path.front().y);
-    EXPECT_FLOAT_EQ(end_node->x, path.back().x);
-    EXPECT_FLOAT_EQ(end_node->y, path.back().y);
+    EXPECT_EQ(path.nodes.size(), 3);
+    EXPECT_EQ(path.distances.size(), 3);
+    EXPECT_EQ(path.nodes.front(), start_node->Index());
+    EXPECT_EQ(path.nodes[1], mid_node->Index());
+    EXPECT_EQ(path.nodes.back(), end_node->Index());
+    EXPECT_FLOAT_EQ(path.distances.front(), 0.0f);
+    EXPECT_FLOAT_EQ(path.Distance(), route_planner.GetDistance());
+    EXPECT_FLOAT_EQ(start_node->x, model.Nodes()[path.nodes.front()].x);
+    EXPECT_FLOAT_EQ(end_node->y, model.Nodes()[path.nodes.back()].y);
 }
 
 
 // Test the AStarSearch method.
 TEST_F(RoutePlannerTest, TestAStarSearch) {
     route_planner.AStarSearch();
-    EXPECT_EQ(model.path.size(), 33);
-    RouteModel::Node path_start = model.path.front();
-    RouteModel::Node path_end = model.path.back();
+    const RoutePath &path = route_planner.Path();
+    EXPECT_EQ(path.nodes.size(), 33);
+    const Model::Node &path_start = model.Nodes()[path.nodes.front()];
+    const Model::Node &path_end = model.Nodes()[path.nodes.back()];
     // The start_node and end_node x, y values should be the same as in the path.
     EXPECT_FLOAT_EQ(start_node->x, path_start.x);
     EXPECT_FLOAT_EQ(start_node->y, path_start.y);
     EXPECT_FLOAT_EQ(end_node->x, path_end.x);
     EXPECT_FLOAT_EQ(end_node->y, path_end.y);
     EXPECT_FLOAT_EQ(route_planner.GetDistance(), 873.41565);
+    EXPECT_NEAR(path.Distance(), route_planner.GetDistance(), 0.01f);
+}
+
+
+// Test that AStarSearch rejects a query into a disconnected road fragment without searching.
+TEST_F(RoutePlannerTest, TestAStarSearchDisconnected) {
+    RoutePlanner disconnected_planner{model, 10, 10, 125.573, 96.9898};
+    disconnected_planner.AStarSearch();
+    EXPECT_TRUE(disconnected_planner.Path().Empty());
+    EXPECT_EQ(disconnected_planner.Path().status, RouteStatus::Disconnected);
+    EXPECT_FALSE(start_node->visited);
+    EXPECT_TRUE(start_node->neighbors.empty());
+}
+
+
+// The trace starts at the start node, ends at the end node, and keeps the open list as the frontier.
+TEST_F(RoutePlannerTest, TestAStarSearchTrace) {
+    SearchTrace trace;
+    route_planner.AStarSearch(&trace);
+    ASSERT_FALSE(trace.settled.empty());
+    EXPECT_EQ(trace.settled.front(), start_node->Index());
+    EXPECT_EQ(trace.settled.back(), end_node->Index());
+    EXPECT_FALSE(trace.frontier.empty());
+    EXPECT_EQ(route_planner.Path().nodes.front(), start_node->Index());
 }
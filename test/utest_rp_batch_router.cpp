@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <random>
+#include <vector>
+#include "../src/batch_router.h"
+#include "../src/distance_matrix.h"
+#include "../src/route_model.h"
+#include "../src/thread_pool.h"
+
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning BatchRouter Tests.
+//--------------------------------//
+
+class BatchRouterTest : public ::testing::Test {
+  protected:
+    std::string osm_data_file = "../map.osm";
+    std::vector<std::byte> osm_data = ReadOSMData(osm_data_file);
+    RouteModel model{osm_data};
+
+    std::vector<RouteQuery> RandomQueries(size_t count) {
+        std::mt19937 rng{7};
+        std::uniform_real_distribution<float> coordinate{0.f, 100.f};
+        std::vector<RouteQuery> queries(count);
+        for (auto &query : queries)
+            query = RouteQuery{{coordinate(rng), coordinate(rng)}, {coordinate(rng), coordinate(rng)}};
+        return queries;
+    }
+};
+
+
+// Every index of a range is run exactly once, however the work is stolen.
+TEST(ThreadPoolTest, TestEveryIndexRunsOnce) {
+    ThreadPool pool{4};
+    std::vector<std::atomic<int>> runs(10007);
+    for (int round = 0; round < 3; round++)
+        pool.ParallelFor(runs.size(), [&](size_t i, unsigned worker) {
+            EXPECT_LT(worker, pool.Size());
+            runs[i]++;
+        });
+    for (auto &count : runs)
+        EXPECT_EQ(count.load(), 3);
+}
+
+
+// The snapping grid finds the same node as scanning every routable node.
+TEST_F(BatchRouterTest, TestSnapMatchesLinearScan) {
+    const RoadGraph &graph = model.Graph();
+    std::mt19937 rng{3};
+    std::uniform_real_distribution<float> coordinate{-0.2f, 1.4f};
+    for (int i = 0; i < 200; i++) {
+        float x = coordinate(rng), y = coordinate(rng);
+        int expected = -1;
+        float best = std::numeric_limits<float>::max();
+        for (int node = 0; node < graph.NodeCount(); node++) {
+            if (!graph.IsRoutable(node))
+                continue;
+            float dx = graph.Position(node).x - x, dy = graph.Position(node).y - y;
+            if (dx * dx + dy * dy < best) {
+                best = dx * dx + dy * dy;
+                expected = node;
+            }
+        }
+        EXPECT_EQ(graph.FindClosestNode(x, y), expected);
+    }
+}
+
+
+// Results come back in input order and match the single-threaded and the many-to-many answers.
+TEST_F(BatchRouterTest, TestResultsInInputOrder) {
+    auto queries = RandomQueries(200);
+    BatchRouter serial{model, 1};
+    BatchRouter parallel{model, 4};
+    auto expected = serial.Route(queries);
+    auto results = parallel.Route(queries);
+    ASSERT_EQ(results.size(), queries.size());
+
+    const RoadGraph &graph = model.Graph();
+    for (size_t i = 0; i < queries.size(); i++) {
+        EXPECT_EQ(results[i].nodes, expected[i].nodes);
+        ASSERT_FALSE(results[i].Empty());
+        EXPECT_EQ(results[i].nodes.front(), graph.FindClosestNode(queries[i].start.x * 0.01f, queries[i].start.y * 0.01f));
+        EXPECT_EQ(results[i].nodes.back(), graph.FindClosestNode(queries[i].end.x * 0.01f, queries[i].end.y * 0.01f));
+        EXPECT_EQ(results[i].nodes.size(), results[i].distances.size());
+        for (size_t k = 1; k < results[i].distances.size(); k++)
+            EXPECT_LE(results[i].distances[k - 1], results[i].distances[k]);
+
+        DistanceMatrix matrix = ComputeDistanceMatrix(model, {queries[i].start}, {queries[i].end}, 1);
+        EXPECT_NEAR(results[i].Distance(), matrix(0, 0), 1e-2);
+    }
+}
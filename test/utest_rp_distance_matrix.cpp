@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+#include <cmath>
+#include <vector>
+#include "../src/graph_search.h"
+#include "../src/route_model.h"
+#include "../src/distance_matrix.h"
+
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning DistanceMatrix Tests.
+//--------------------------------//
+
+class DistanceMatrixTest : public ::testing::Test {
+  protected:
+    std::string osm_data_file = "../map.osm";
+    std::vector<std::byte> osm_data = ReadOSMData(osm_data_file);
+    RouteModel model{osm_data};
+    std::vector<MapCoordinate> points{{10, 10}, {90, 90}, {50, 50}, {20, 80}, {75, 30}};
+};
+
+
+// The matrix of a point set against itself is symmetric with a zero diagonal.
+TEST_F(DistanceMatrixTest, TestSymmetricWithZeroDiagonal) {
+    DistanceMatrix matrix = ComputeDistanceMatrix(model, points, points);
+    ASSERT_EQ(matrix.Rows(), points.size());
+    ASSERT_EQ(matrix.Cols(), points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        EXPECT_FLOAT_EQ(matrix(i, i), 0.0f);
+        for (size_t j = 0; j < points.size(); j++) {
+            EXPECT_TRUE(std::isfinite(matrix(i, j)));
+            EXPECT_NEAR(matrix(i, j), matrix(j, i), 1e-2);
+        }
+    }
+    EXPECT_GT(matrix(0, 1), 0.0f);
+}
+
+
+// The result does not depend on the number of worker threads.
+TEST_F(DistanceMatrixTest, TestThreadCountIndependent) {
+    std::vector<MapCoordinate> targets{{90, 90}, {20, 80}, {10, 10}};
+    DistanceMatrix serial = ComputeDistanceMatrix(model, points, targets, 1);
+    DistanceMatrix parallel = ComputeDistanceMatrix(model, points, targets, 4);
+    EXPECT_EQ(serial.Values(), parallel.Values());
+}
+
+
+// Every entry is the distance of the single-pair search between the snapped end points, so a wrong but
+// symmetric and stable matrix does not pass either.
+TEST_F(DistanceMatrixTest, TestMatchesSinglePairSearch) {
+    std::vector<MapCoordinate> targets{{90, 90}, {20, 80}, {10, 10}, {60, 40}};
+    DistanceMatrix matrix = ComputeDistanceMatrix(model, points, targets);
+    const RoadGraph &graph = model.Graph();
+    SearchWorkspace workspace;
+    RoutePath path;
+    for (size_t i = 0; i < points.size(); i++)
+        for (size_t j = 0; j < targets.size(); j++) {
+            int source = graph.FindClosestNode(points[i].x * 0.01f, points[i].y * 0.01f);
+            int target = graph.FindClosestNode(targets[j].x * 0.01f, targets[j].y * 0.01f);
+            ASSERT_TRUE(FindShortestPath(graph, source, target, workspace, path));
+            EXPECT_NEAR(matrix(i, j), path.Distance(), 1e-2);
+        }
+    EXPECT_NEAR(matrix(0, 0), 839.26306f, 1e-2);
+}
@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../src/feature_index.h"
+#include "../src/route_model.h"
+
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning FeatureIndex Tests.
+//--------------------------------//
+
+static std::vector<int> BruteForce(const std::vector<BoundingBox> &boxes, const BoundingBox &view) {
+    std::vector<int> result;
+    for (int i = 0; i < (int)boxes.size(); i++)
+        if (boxes[i].Intersects(view))
+            result.push_back(i);
+    return result;
+}
+
+
+// Queries return exactly the intersecting boxes, in ascending order, for trees of one to several levels.
+TEST(FeatureIndexTest, TestQueryMatchesBruteForce) {
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> position{0.f, 1.f};
+    std::uniform_real_distribution<float> extent{0.f, 0.02f};
+    for (int count : {1, 15, 16, 17, 300, 5000}) {
+        std::vector<BoundingBox> boxes(count);
+        for (auto &box : boxes) {
+            box.Extend(position(rng), position(rng));
+            box.Extend(box.min_x + extent(rng), box.min_y + extent(rng));
+        }
+        boxes[count / 2] = BoundingBox{};
+        FeatureIndex index{boxes};
+        ASSERT_EQ(index.Size(), count);
+
+        std::vector<int> result;
+        for (int query = 0; query < 50; query++) {
+            BoundingBox view;
+            view.Extend(position(rng), position(rng));
+            view.Extend(position(rng), position(rng));
+            index.Query(view, result);
+            ASSERT_EQ(result, BruteForce(boxes, view));
+        }
+        BoundingBox everything;
+        everything.Extend(0.f, 0.f);
+        everything.Extend(2.f, 2.f);
+        index.Query(everything, result);
+        EXPECT_EQ((int)result.size(), count - 1);
+    }
+}
+
+
+TEST(FeatureIndexTest, TestEmpty) {
+    FeatureIndex index;
+    BoundingBox view;
+    view.Extend(0.f, 0.f);
+    view.Extend(1.f, 1.f);
+    std::vector<int> result{1, 2};
+    index.Query(view, result);
+    EXPECT_TRUE(result.empty());
+    EXPECT_FALSE(BoundingBox{}.Intersects(view));
+}
+
+
+// Feature boxes cover their geometry, so a view around a road's first node finds that road.
+TEST(FeatureIndexTest, TestModelBounds) {
+    RouteModel model{ReadOSMData("../map.osm")};
+    std::vector<BoundingBox> boxes;
+    for (auto &road : model.Roads())
+        boxes.push_back(WayBounds(model, model.Ways()[road.way]));
+    FeatureIndex index{boxes};
+
+    const auto &road = model.Roads()[0];
+    const auto &node = model.Nodes()[model.Ways()[road.way].nodes.front()];
+    BoundingBox view;
+    view.Extend((float)node.x, (float)node.y);
+    std::vector<int> result;
+    index.Query(view, result);
+    EXPECT_NE(std::find(result.begin(), result.end(), 0), result.end());
+    EXPECT_LT(result.size(), model.Roads().size());
+
+    BoundingBox building = MultipolygonBounds(model, model.Buildings()[0]);
+    EXPECT_FALSE(building.Empty());
+    for (int way : model.Buildings()[0].outer)
+        for (int n : model.Ways()[way].nodes) {
+            EXPECT_GE((float)model.Nodes()[n].x, building.min_x);
+            EXPECT_LE((float)model.Nodes()[n].x, building.max_x);
+        }
+}
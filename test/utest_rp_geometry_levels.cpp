@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include <cmath>
+#include <random>
+#include <vector>
+#include "../src/geometry_levels.h"
+
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning GeometryLevels Tests.
+//--------------------------------//
+
+// Textbook recursive Douglas-Peucker to compare against.
+static void ReferenceSimplify(const std::vector<Model::Node> &points, int first, int last, double tolerance,
+                              std::vector<int> &kept) {
+    int split = -1;
+    double farthest = -1.0;
+    const auto &a = points[first], &b = points[last];
+    for (int i = first + 1; i < last; i++) {
+        double dx = b.x - a.x, dy = b.y - a.y, length_sq = dx * dx + dy * dy;
+        double t = length_sq > 0 ? ((points[i].x - a.x) * dx + (points[i].y - a.y) * dy) / length_sq : 0.0;
+        t = std::min(1.0, std::max(0.0, t));
+        double distance = std::hypot(points[i].x - (a.x + t * dx), points[i].y - (a.y + t * dy));
+        if (distance > farthest) {
+            farthest = distance;
+            split = i;
+        }
+    }
+    if (split >= 0 && farthest > tolerance) {
+        ReferenceSimplify(points, first, split, tolerance, kept);
+        kept.push_back(split);
+        ReferenceSimplify(points, split, last, tolerance, kept);
+    }
+}
+
+
+TEST(GeometryLevelsTest, TestSimplifyMatchesReference) {
+    std::mt19937 rng{11};
+    std::normal_distribution<double> step{0.0, 1.0};
+    for (int run = 0; run < 20; run++) {
+        std::vector<Model::Node> points(2 + run * 10);
+        for (size_t i = 1; i < points.size(); i++)
+            points[i] = Model::Node{points[i - 1].x + 1.0 + step(rng), points[i - 1].y + step(rng)};
+        for (double tolerance : {0.0, 0.1, 0.5, 1.0, 3.0, 100.0}) {
+            std::vector<int> expected{0};
+            ReferenceSimplify(points, 0, (int)points.size() - 1, tolerance, expected);
+            expected.push_back((int)points.size() - 1);
+            ASSERT_EQ(SimplifyPolyline(points, tolerance), expected);
+        }
+    }
+}
+
+
+TEST(GeometryLevelsTest, TestSimplifyShapes) {
+    std::vector<Model::Node> line{{0, 0}, {1, 0}, {2, 0}, {3, 0}};
+    EXPECT_EQ(SimplifyPolyline(line, 0.0), (std::vector<int>{0, 3}));
+    std::vector<Model::Node> ring{{0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 0}};
+    EXPECT_EQ(SimplifyPolyline(ring, 0.5), (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_EQ(SimplifyPolyline(ring, 1.2), (std::vector<int>{0, 2, 4}));
+    EXPECT_TRUE(SimplifyPolyline({}, 1.0).empty());
+}
+
+
+// Every level of the map's ways is the Douglas-Peucker result for its tolerance, and coarse levels are smaller.
+TEST(GeometryLevelsTest, TestModelLevels) {
+    Model model{ReadOSMData("../map.osm")};
+    GeometryLevels levels{model};
+    EXPECT_EQ(GeometryLevels::LevelFor(0.0), 0);
+    EXPECT_EQ(GeometryLevels::LevelFor(GeometryLevels::Tolerance(3) * 1.5), 3);
+    EXPECT_EQ(GeometryLevels::LevelFor(1.0), GeometryLevels::kLevels - 1);
+
+    for (int way = 0; way < (int)model.Ways().size(); way += 7) {
+        std::vector<Model::Node> points;
+        for (int node : model.Ways()[way].nodes)
+            points.push_back(model.Nodes()[node]);
+        for (int level = 0; level < GeometryLevels::kLevels; level++) {
+            auto span = levels.WayNodes(way, level);
+            std::vector<int> nodes(span.begin(), span.end());
+            std::vector<int> expected;
+            if (level == 0)
+                expected = model.Ways()[way].nodes;
+            else
+                for (int i : SimplifyPolyline(points, GeometryLevels::Tolerance(level)))
+                    expected.push_back(model.Ways()[way].nodes[i]);
+            ASSERT_EQ(nodes, expected);
+        }
+    }
+
+    for (int level = 1; level < GeometryLevels::kLevels; level++)
+        EXPECT_LE(levels.VertexCount(level), levels.VertexCount(level - 1));
+    // Most ways of the sample map are short, and their end points always stay.
+    EXPECT_LT(levels.VertexCount(GeometryLevels::kLevels - 1) * 2, levels.VertexCount(0));
+}
@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include <vector>
+#include "../src/route_model.h"
+#include "../src/distance_matrix.h"
+#include "../src/isochrone.h"
+
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning Isochrone Tests.
+//--------------------------------//
+
+class IsochroneTest : public ::testing::Test {
+  protected:
+    std::string osm_data_file = "../map.osm";
+    std::vector<std::byte> osm_data = ReadOSMData(osm_data_file);
+    RouteModel model{osm_data};
+    MapCoordinate depot{50, 50};
+};
+
+
+// Every node within the bound is settled, in non-decreasing order of distance.
+TEST_F(IsochroneTest, TestReachableNodesWithinBound) {
+    ShortestPathTree tree = ComputeReachableNodes(model, depot, 300.0f);
+    ASSERT_FALSE(tree.nodes.empty());
+    EXPECT_EQ(tree.nodes.size(), tree.distances.size());
+    EXPECT_EQ(tree.nodes.front(), tree.source);
+    EXPECT_FLOAT_EQ(tree.distances.front(), 0.0f);
+    for (size_t i = 1; i < tree.distances.size(); i++) {
+        EXPECT_LE(tree.distances[i - 1], tree.distances[i]);
+        EXPECT_LE(tree.distances[i], 300.0f);
+    }
+
+    // A larger bound settles a superset of the nodes.
+    ShortestPathTree larger = ComputeReachableNodes(model, depot, 600.0f);
+    EXPECT_GT(larger.nodes.size(), tree.nodes.size());
+}
+
+
+// The tree agrees with the distances of the many-to-many search.
+TEST_F(IsochroneTest, TestDistancesMatchMatrix) {
+    ShortestPathTree tree = ComputeReachableNodes(model, depot, 10000.0f);
+    const auto &graph = model.Graph();
+    std::vector<MapCoordinate> targets;
+    for (size_t i = 0; i < tree.nodes.size(); i += tree.nodes.size() / 10 + 1) {
+        const auto &p = graph.Position(tree.nodes[i]);
+        targets.push_back({p.x * 100.0f, p.y * 100.0f});
+    }
+    DistanceMatrix matrix = ComputeDistanceMatrix(model, {depot}, targets);
+    for (size_t i = 0, k = 0; i < tree.nodes.size(); i += tree.nodes.size() / 10 + 1, k++)
+        EXPECT_NEAR(matrix(0, k), tree.distances[i], 1e-2);
+}
+
+
+// Counts how often a ray from the point towards +x crosses the rings, so odd means inside (even-odd rule).
+static bool InsideContours(const Isochrone &isochrone, const RoadGraph::Point &p) {
+    bool inside = false;
+    for (const auto &ring : isochrone.contours)
+        for (size_t i = 1; i < ring.size(); i++) {
+            const auto &a = ring[i - 1], &b = ring[i];
+            if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) / (b.y - a.y) * (b.x - a.x))
+                inside = !inside;
+        }
+    return inside;
+}
+
+
+// Every level yields closed contours, and larger levels enclose more.
+TEST_F(IsochroneTest, TestContoursAreClosed) {
+    ShortestPathTree tree = ComputeReachableNodes(model, depot, 800.0f);
+    std::vector<Isochrone> isochrones = ComputeIsochrones(model, tree, {200.0f, 800.0f});
+    ASSERT_EQ(isochrones.size(), 2);
+    for (const auto &isochrone : isochrones) {
+        EXPECT_FALSE(isochrone.contours.empty());
+        for (const auto &ring : isochrone.contours) {
+            ASSERT_GE(ring.size(), 4);
+            EXPECT_FLOAT_EQ(ring.front().x, ring.back().x);
+            EXPECT_FLOAT_EQ(ring.front().y, ring.back().y);
+        }
+    }
+    EXPECT_FLOAT_EQ(isochrones[0].distance, 200.0f);
+
+    // Nodes inside the 200 m contour and nodes within 200 m lie inside the 800 m contour. The grid only resolves
+    // the field to about a cell, so nodes are expected inside the 200 m contour only well below that distance.
+    const auto &graph = model.Graph();
+    int near = 0, only_outer = 0;
+    for (size_t i = 0; i < tree.nodes.size(); i++) {
+        const auto &p = graph.Position(tree.nodes[i]);
+        if (tree.distances[i] <= 200.0f || InsideContours(isochrones[0], p)) {
+            EXPECT_TRUE(InsideContours(isochrones[1], p));
+        }
+        if (tree.distances[i] <= 100.0f) {
+            near++;
+            EXPECT_TRUE(InsideContours(isochrones[0], p));
+        }
+        if (tree.distances[i] >= 400.0f && tree.distances[i] <= 600.0f) {
+            only_outer++;
+            EXPECT_FALSE(InsideContours(isochrones[0], p));
+            EXPECT_TRUE(InsideContours(isochrones[1], p));
+        }
+    }
+    EXPECT_GT(near, 0);
+    EXPECT_GT(only_outer, 0);
+}
@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "../src/region_registry.h"
+
+//--------------------------------//
+//   Beginning RegionRegistry Tests.
+//--------------------------------//
+
+// The bounds of map.osm.
+static constexpr double kMinLat = 30.27059, kMaxLat = 30.27957, kMinLon = -97.74541, kMaxLon = -97.73195;
+
+TEST(RegionRegistryTest, TestReadBounds) {
+    GeoBounds bounds;
+    ASSERT_TRUE(ReadOsmBounds("../map.osm", bounds));
+    EXPECT_DOUBLE_EQ(bounds.min_lat, kMinLat);
+    EXPECT_DOUBLE_EQ(bounds.max_lat, kMaxLat);
+    EXPECT_DOUBLE_EQ(bounds.min_lon, kMinLon);
+    EXPECT_DOUBLE_EQ(bounds.max_lon, kMaxLon);
+    EXPECT_FALSE(ReadOsmBounds("../does_not_exist.osm", bounds));
+}
+
+
+// Regions are only loaded when first requested, and positions are mapped to the region covering them.
+TEST(RegionRegistryTest, TestLazyLoadAndLookup) {
+    RegionRegistry registry{std::size_t{1} << 30};
+    ASSERT_TRUE(registry.Register("austin", "../map.osm"));
+    EXPECT_FALSE(registry.Register("austin", "../map.osm"));
+    EXPECT_FALSE(registry.Register("missing", "../does_not_exist.osm"));
+    EXPECT_EQ(registry.LoadedCount(), 0);
+    EXPECT_EQ(registry.MemoryUsage(), 0);
+
+    double lat = (kMinLat + kMaxLat) / 2, lon = (kMinLon + kMaxLon) / 2;
+    EXPECT_EQ(registry.FindRegion(lat, lon), "austin");
+    EXPECT_EQ(registry.FindRegion(kMaxLat + 1, lon), "");
+    EXPECT_EQ(registry.Get("unknown"), nullptr);
+
+    auto model = registry.Get("austin");
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(registry.Get("austin"), model);
+    EXPECT_EQ(registry.LoadedCount(), 1);
+    EXPECT_EQ(registry.MemoryUsage(), model->MemoryUsage());
+
+    SearchWorkspace workspace;
+    RoutePath path;
+    EXPECT_EQ(registry.Route(kMinLat + 0.001, kMinLon + 0.001, kMaxLat - 0.001, kMaxLon - 0.001, workspace, path), model);
+    EXPECT_FALSE(path.Empty());
+    EXPECT_GT(path.Distance(), 0.f);
+    EXPECT_EQ(registry.Route(lat, lon, kMaxLat + 1, lon, workspace, path), nullptr);
+    EXPECT_TRUE(path.Empty());
+}
+
+
+// Over budget the least recently used region is dropped, but models still in use stay valid.
+TEST(RegionRegistryTest, TestEviction) {
+    RegionRegistry registry{1};
+    ASSERT_TRUE(registry.Register("first", "../map.osm"));
+    ASSERT_TRUE(registry.Register("second", "../map.osm"));
+
+    // The region that was just requested is kept even if it alone exceeds the budget.
+    std::weak_ptr<const RouteModel> unused = registry.Get("first");
+    EXPECT_FALSE(unused.expired());
+    EXPECT_EQ(registry.LoadedCount(), 1);
+
+    auto held = registry.Get("first");
+    auto second = registry.Get("second");
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(registry.LoadedCount(), 1);
+    EXPECT_EQ(registry.MemoryUsage(), second->MemoryUsage());
+    EXPECT_GT(held->Graph().NodeCount(), 0);
+    held.reset();
+    EXPECT_TRUE(unused.expired());
+}
+
+
+// With nested regions a query is routed in the smallest region that covers both end points, not just the start.
+TEST(RegionRegistryTest, TestNestedRegions) {
+    // A "city" extract covering the south-west quarter of map.osm, which plays the metro area.
+    const double mid_lat = (kMinLat + kMaxLat) / 2, mid_lon = (kMinLon + kMaxLon) / 2;
+    std::string city = testing::TempDir() + "route_planner_test_city.osm";
+    std::ofstream{city} << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<osm version=\"0.6\">\n <bounds minlat=\""
+                        << std::to_string(kMinLat) << "\" minlon=\"" << std::to_string(kMinLon) << "\" maxlat=\""
+                        << std::to_string(mid_lat) << "\" maxlon=\"" << std::to_string(mid_lon) << "\"/>\n</osm>\n";
+
+    RegionRegistry registry{std::size_t{1} << 30};
+    ASSERT_TRUE(registry.Register("metro", "../map.osm"));
+    ASSERT_TRUE(registry.Register("city", city));
+    std::remove(city.c_str());
+
+    const double city_lat = kMinLat + 0.001, city_lon = kMinLon + 0.001;
+    const double suburb_lat = kMaxLat - 0.001, suburb_lon = kMaxLon - 0.001;
+    EXPECT_EQ(registry.FindRegion(city_lat, city_lon), "city");
+    EXPECT_EQ(registry.FindRegion(city_lat, city_lon, city_lat + 0.001, city_lon + 0.001), "city");
+    EXPECT_EQ(registry.FindRegion(city_lat, city_lon, suburb_lat, suburb_lon), "metro");
+    EXPECT_EQ(registry.FindRegion(city_lat, city_lon, kMaxLat + 1, suburb_lon), "");
+
+    // City to suburb is answered by the metro model, and the city model is never loaded for it.
+    SearchWorkspace workspace;
+    RoutePath path;
+    auto model = registry.Route(city_lat, city_lon, suburb_lat, suburb_lon, workspace, path);
+    ASSERT_NE(model, nullptr);
+    EXPECT_EQ(model, registry.Get("metro"));
+    EXPECT_FALSE(path.Empty());
+    EXPECT_EQ(registry.LoadedCount(), 1);
+}
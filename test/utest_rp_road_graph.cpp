@@ -0,0 +1,226 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <vector>
+#include "../src/graph_search.h"
+#include "../src/route_model.h"
+#include "../src/route_request.h"
+
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning RoadGraph Tests.
+//--------------------------------//
+
+class RoadGraphTest : public ::testing::Test {
+  protected:
+    std::string osm_data_file = "../map.osm";
+    std::vector<std::byte> osm_data = ReadOSMData(osm_data_file);
+    RouteModel model{osm_data};
+    const RoadGraph &graph = model.Graph();
+};
+
+
+// Every routable node is either a core node or lies on exactly one chain, and the chains cover the graph.
+TEST_F(RoadGraphTest, TestChainsCoverGraph) {
+    int core = 0, interior = 0;
+    for (int node = 0; node < graph.NodeCount(); node++) {
+        if (!graph.IsRoutable(node))
+            continue;
+        if (graph.IsCore(node)) {
+            core++;
+            EXPECT_EQ(graph.ChainPosition(node), -1);
+        } else {
+            interior++;
+            int chain = graph.ChainOf(node);
+            ASSERT_GE(chain, 0);
+            EXPECT_GE(graph.ChainPosition(node), graph.ChainBegin(chain));
+            EXPECT_LT(graph.ChainPosition(node), graph.ChainEnd(chain));
+            EXPECT_EQ(graph.ChainNode(graph.ChainPosition(node)), node);
+            EXPECT_EQ(graph.EdgesEnd(node) - graph.EdgesBegin(node), 2);
+        }
+    }
+    EXPECT_GT(interior, 0);
+    EXPECT_EQ(graph.ChainBegin(graph.ChainCount()), interior);
+
+    // Every chain is a walk along edges whose length adds up to the chain length.
+    for (int c = 0; c < graph.ChainCount(); c++) {
+        const auto &chain = graph.GetChain(c);
+        EXPECT_TRUE(graph.IsCore(chain.from));
+        EXPECT_TRUE(graph.IsCore(chain.to));
+        int previous = chain.from;
+        float length = 0.f;
+        std::vector<int> walk;
+        for (int p = graph.ChainBegin(c); p < graph.ChainEnd(c); p++)
+            walk.push_back(graph.ChainNode(p));
+        walk.push_back(chain.to);
+        for (int node : walk) {
+            bool adjacent = false;
+            for (auto edge = graph.EdgesBegin(previous); edge != graph.EdgesEnd(previous); ++edge)
+                adjacent |= edge->to == node;
+            ASSERT_TRUE(adjacent);
+            length += graph.Distance(previous, node);
+            previous = node;
+        }
+        EXPECT_NEAR(chain.length, length, 1e-5f);
+    }
+}
+
+
+// Shortest paths on the compressed view are as long as on the full graph and unpack to adjacent nodes.
+TEST_F(RoadGraphTest, TestCompressedSearchMatchesDijkstra) {
+    std::vector<int> routable;
+    for (int node = 0; node < graph.NodeCount(); node++)
+        if (graph.IsRoutable(node))
+            routable.push_back(node);
+
+    std::mt19937 random{42};
+    std::uniform_int_distribution<size_t> pick{0, routable.size() - 1};
+    SearchWorkspace workspace;
+    RoutePath path;
+    for (int query = 0; query < 300; query++) {
+        int source = routable[pick(random)], target = routable[pick(random)];
+        float expected;
+        DistancesToTargets(graph, source, {target}, workspace, &expected);
+
+        bool found = FindShortestPath(graph, source, target, workspace, path);
+        ASSERT_EQ(found, std::isfinite(expected));
+        if (!found)
+            continue;
+        ASSERT_EQ(path.nodes.front(), source);
+        ASSERT_EQ(path.nodes.back(), target);
+        ASSERT_EQ(path.distances.size(), path.nodes.size());
+        EXPECT_NEAR(path.Distance(), expected * graph.MetricScale(), 1e-3f);
+        for (size_t i = 1; i < path.nodes.size(); i++) {
+            bool adjacent = false;
+            for (auto edge = graph.EdgesBegin(path.nodes[i - 1]); edge != graph.EdgesEnd(path.nodes[i - 1]); ++edge)
+                adjacent |= edge->to == path.nodes[i];
+            ASSERT_TRUE(adjacent);
+            ASSERT_GE(path.distances[i], path.distances[i - 1]);
+        }
+    }
+}
+
+
+// The compressed view is much smaller, and the search still returns the route of the uncompressed search.
+TEST_F(RoadGraphTest, TestCompressedSearchKeepsRoute) {
+    int routable = 0, core = 0;
+    for (int node = 0; node < graph.NodeCount(); node++) {
+        routable += graph.IsRoutable(node);
+        core += graph.IsCore(node);
+    }
+    EXPECT_LT(core * 2, routable);
+
+    SearchWorkspace workspace;
+    RoutePath path;
+    int source = graph.FindClosestNode(0.1f, 0.1f), target = graph.FindClosestNode(0.9f, 0.9f);
+    ASSERT_TRUE(FindShortestPath(graph, source, target, workspace, path));
+    EXPECT_EQ(path.nodes.size(), 70);
+    EXPECT_FLOAT_EQ(path.Distance(), 839.26306f);
+}
+
+
+// A trace records the settled core nodes in settle order and a frontier of queued nodes that were not settled.
+TEST_F(RoadGraphTest, TestSearchTrace) {
+    SearchWorkspace workspace;
+    RoutePath path, traced_path;
+    SearchTrace trace;
+    int source = graph.FindClosestNode(0.1f, 0.1f), target = graph.FindClosestNode(0.9f, 0.9f);
+    ASSERT_TRUE(FindShortestPath(graph, source, target, workspace, path));
+    ASSERT_TRUE(FindShortestPath(graph, source, target, workspace, traced_path, &trace));
+    EXPECT_EQ(traced_path.nodes, path.nodes);
+
+    // The target of this query is a core node, so the search settles it last.
+    ASSERT_TRUE(graph.IsCore(target));
+    ASSERT_FALSE(trace.settled.empty());
+    EXPECT_EQ(trace.settled.back(), target);
+    std::vector<int> settled = trace.settled, frontier = trace.frontier;
+    std::sort(settled.begin(), settled.end());
+    std::sort(frontier.begin(), frontier.end());
+    EXPECT_EQ(std::adjacent_find(settled.begin(), settled.end()), settled.end());
+    EXPECT_EQ(std::adjacent_find(frontier.begin(), frontier.end()), frontier.end());
+    for (int node : frontier) {
+        EXPECT_TRUE(graph.IsCore(node));
+        EXPECT_FALSE(std::binary_search(settled.begin(), settled.end(), node));
+    }
+
+    // A new search clears the previous trace.
+    ASSERT_TRUE(FindShortestPath(graph, source, source, workspace, path, &trace));
+    EXPECT_TRUE(trace.Empty());
+}
+
+
+// Components partition the routable nodes, and edges never leave a component.
+TEST_F(RoadGraphTest, TestComponents) {
+    ASSERT_GT(graph.ComponentCount(), 1);
+    ASSERT_GE(graph.LargestComponent(), 0);
+    std::vector<int> sizes(graph.ComponentCount(), 0);
+    for (int node = 0; node < graph.NodeCount(); node++) {
+        if (!graph.IsRoutable(node)) {
+            EXPECT_EQ(graph.Component(node), -1);
+            continue;
+        }
+        ASSERT_GE(graph.Component(node), 0);
+        sizes[graph.Component(node)]++;
+        for (auto edge = graph.EdgesBegin(node); edge != graph.EdgesEnd(node); ++edge)
+            EXPECT_EQ(graph.Component(edge->to), graph.Component(node));
+    }
+    for (int size : sizes)
+        EXPECT_LE(size, sizes[graph.LargestComponent()]);
+}
+
+
+// Queries between components fail right away with their own status; snapping can avoid small components.
+TEST_F(RoadGraphTest, TestDisconnectedQuery) {
+    // A small road fragment east of the visible map area.
+    int fragment = graph.FindClosestNode(1.25573f, 0.969898f);
+    int source = graph.FindClosestNode(0.1f, 0.1f);
+    ASSERT_NE(graph.Component(fragment), graph.Component(source));
+    EXPECT_FALSE(graph.Connected(source, fragment));
+
+    SearchWorkspace workspace;
+    RoutePath path;
+    EXPECT_FALSE(FindShortestPath(graph, source, fragment, workspace, path));
+    EXPECT_EQ(path.status, RouteStatus::Disconnected);
+    EXPECT_TRUE(path.Empty());
+    std::ostringstream response;
+    WriteRouteResponse(response, JsonValue{}, path, graph);
+    EXPECT_EQ(response.str(), "{\"id\":null,\"error\":\"start and end are not connected\"}\n");
+
+    int snapped = graph.FindClosestNode(1.25573f, 0.969898f, true);
+    EXPECT_EQ(graph.Component(snapped), graph.LargestComponent());
+    EXPECT_TRUE(FindShortestPath(graph, source, snapped, workspace, path));
+    EXPECT_EQ(path.status, RouteStatus::Found);
+}
+
+
+// A parallel build produces exactly the same graph and neighbors as a serial one, and reports its phases.
+TEST_F(RoadGraphTest, TestParallelBuildIsDeterministic) {
+    BuildReport report;
+    RouteModel serial{osm_data, 1};
+    RouteModel parallel{osm_data, 4, &report};
+
+    auto image_bytes = [](const RoadGraph &graph, const std::string &name) {
+        std::string path = testing::TempDir() + name;
+        EXPECT_TRUE(graph.WriteImage(path));
+        std::ifstream is{path, std::ios::binary};
+        return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    };
+    auto serial_image = image_bytes(serial.Graph(), "route_planner_serial.graph");
+    EXPECT_FALSE(serial_image.empty());
+    EXPECT_EQ(image_bytes(parallel.Graph(), "route_planner_parallel.graph"), serial_image);
+
+    for (size_t i = 0; i < serial.SNodes().size(); i++) {
+        serial.SNodes()[i].FindNeighbors();
+        parallel.SNodes()[i].FindNeighbors();
+        ASSERT_EQ(serial.SNodes()[i].neighbors.size(), parallel.SNodes()[i].neighbors.size());
+        for (size_t k = 0; k < serial.SNodes()[i].neighbors.size(); k++)
+            ASSERT_EQ(serial.SNodes()[i].neighbors[k]->Index(), parallel.SNodes()[i].neighbors[k]->Index());
+    }
+
+    ASSERT_FALSE(report.Phases().empty());
+    EXPECT_EQ(report.Phases().front().first, "model nodes");
+    EXPECT_EQ(report.Phases().back().first, "graph snap grid");
+}
@@ -0,0 +1,36 @@
+#include "gtest/gtest.h"
+#include "../src/rolling_percentiles.h"
+
+//--------------------------------//
+//   Beginning RollingPercentiles Tests.
+//--------------------------------//
+
+// Nearest-rank percentiles of a full window, independent of the order the samples arrived in.
+TEST(RollingPercentilesTest, TestPercentiles) {
+    RollingPercentiles window{100};
+    EXPECT_EQ(window.Percentile(50), 0.0);
+    for (int i = 100; i >= 1; i--)
+        window.Add(i);
+    EXPECT_EQ(window.Count(), 100);
+    EXPECT_EQ(window.Percentile(0), 1.0);
+    EXPECT_EQ(window.Percentile(50), 50.0);
+    EXPECT_EQ(window.Percentile(95), 95.0);
+    EXPECT_EQ(window.Percentile(99.5), 100.0);
+    EXPECT_EQ(window.Percentile(100), 100.0);
+}
+
+
+// Once the window is full the oldest samples drop out.
+TEST(RollingPercentilesTest, TestWindowRolls) {
+    RollingPercentiles window{4};
+    for (double sample : {100.0, 100.0, 1.0, 2.0, 3.0, 4.0})
+        window.Add(sample);
+    EXPECT_EQ(window.Count(), 4);
+    EXPECT_EQ(window.Percentile(100), 4.0);
+    EXPECT_EQ(window.Percentile(50), 2.0);
+
+    window.Clear();
+    EXPECT_EQ(window.Count(), 0);
+    window.Add(7.0);
+    EXPECT_EQ(window.Percentile(10), 7.0);
+}
@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+#include <string>
+#include "../src/route_cache.h"
+#include "../src/route_service.h"
+#include "../src/routing_engine.h"
+
+//--------------------------------//
+//   Beginning RouteCache Tests.
+//--------------------------------//
+
+static RoutePath MakePath(int length) {
+    RoutePath path;
+    for (int i = 0; i < length; i++) {
+        path.nodes.push_back(i);
+        path.distances.push_back(i * 10.f);
+    }
+    return path;
+}
+
+
+TEST(RouteCacheTest, TestHitAndMiss) {
+    RouteCache cache{1 << 20};
+    RoutePath path;
+    EXPECT_FALSE(cache.Lookup(1, {1, 2}, path));
+    cache.Insert(1, {1, 2}, MakePath(5));
+    ASSERT_TRUE(cache.Lookup(1, {1, 2}, path));
+    EXPECT_EQ(path.nodes.size(), 5);
+    EXPECT_FLOAT_EQ(path.Distance(), 40.f);
+    EXPECT_FALSE(cache.Lookup(1, {2, 1}, path));
+    EXPECT_FALSE(cache.Lookup(1, {1, 2, 1}, path));
+    EXPECT_EQ(cache.Hits(), 1);
+    EXPECT_EQ(cache.Misses(), 3);
+    EXPECT_EQ(cache.Size(), 1);
+}
+
+
+// The least recently used route goes first once the byte budget is exhausted.
+TEST(RouteCacheTest, TestEviction) {
+    RouteCache cache{4096, 1};
+    RoutePath path;
+    int inserted = 0;
+    while (cache.MemoryUsage() + 1024 <= 4096)
+        cache.Insert(1, {inserted++, 0}, MakePath(100));
+    ASSERT_GE(inserted, 2);
+    EXPECT_TRUE(cache.Lookup(1, {0, 0}, path));
+    cache.Insert(1, {inserted, 0}, MakePath(100));
+    EXPECT_LE(cache.MemoryUsage(), 4096);
+    EXPECT_TRUE(cache.Lookup(1, {0, 0}, path));
+    EXPECT_FALSE(cache.Lookup(1, {1, 0}, path));
+    EXPECT_TRUE(cache.Lookup(1, {inserted, 0}, path));
+
+    // A route that does not fit at all is not cached.
+    cache.Insert(1, {-1, -1}, MakePath(1000));
+    EXPECT_FALSE(cache.Lookup(1, {-1, -1}, path));
+}
+
+
+// Routes of an older graph are dropped by the first access with a newer one.
+TEST(RouteCacheTest, TestGenerations) {
+    RouteCache cache{1 << 20, 1};
+    RoutePath path;
+    cache.Insert(1, {1, 2}, MakePath(3));
+    EXPECT_FALSE(cache.Lookup(2, {1, 2}, path));
+    EXPECT_EQ(cache.Size(), 0);
+    cache.Insert(1, {1, 2}, MakePath(3));
+    EXPECT_FALSE(cache.Lookup(1, {1, 2}, path));
+    cache.Insert(2, {1, 2}, MakePath(3));
+    EXPECT_TRUE(cache.Lookup(2, {1, 2}, path));
+}
+
+
+// The service answers a repeated request from the cache with the same response, and a reload invalidates it.
+TEST(RouteCacheTest, TestService) {
+    RoutingEngine engine;
+    ASSERT_TRUE(engine.Load("../map.osm"));
+    RouteCache cache{1 << 20};
+    RouteService service{engine, &cache};
+    SearchWorkspace workspace;
+
+    std::string request = "{\"id\":1,\"start\":[10,10],\"end\":[90,90]}";
+    std::string first = service.Handle(request, workspace);
+    std::string second = service.Handle(request, workspace);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(cache.Hits(), 1);
+    EXPECT_EQ(cache.Misses(), 1);
+
+    ASSERT_TRUE(engine.Load("../map.osm"));
+    EXPECT_EQ(service.Handle(request, workspace), first);
+    EXPECT_EQ(cache.Hits(), 1);
+    EXPECT_EQ(cache.Misses(), 2);
+}
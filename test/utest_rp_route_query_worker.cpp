@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../src/graph_search.h"
+#include "../src/route_model.h"
+#include "../src/route_query_worker.h"
+
+std::vector<std::byte> ReadOSMData(const std::string &path);
+
+//--------------------------------//
+//   Beginning RouteQueryWorker Tests.
+//--------------------------------//
+
+class RouteQueryWorkerTest : public ::testing::Test {
+  protected:
+    std::string osm_data_file = "../map.osm";
+    std::vector<std::byte> osm_data = ReadOSMData(osm_data_file);
+    RouteModel model{osm_data};
+    const RoadGraph &graph = model.Graph();
+
+    // Polls the worker like a drawing thread would, until the result of the given query shows up.
+    std::optional<RouteQueryWorker::Result> WaitFor(RouteQueryWorker &worker, std::uint64_t id,
+                                                    std::vector<std::uint64_t> &seen) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (auto result = worker.TakeResult()) {
+                seen.push_back(result->id);
+                if (result->id == id)
+                    return result;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return std::nullopt;
+    }
+};
+
+
+// A query on the worker gives the same route as the search on the calling thread.
+TEST_F(RouteQueryWorkerTest, TestQueryMatchesSearch) {
+    SearchWorkspace workspace;
+    RoutePath expected;
+    ASSERT_TRUE(FindShortestPath(graph, graph.FindClosestNode(0.1f, 0.1f), graph.FindClosestNode(0.9f, 0.9f),
+                                 workspace, expected));
+
+    RouteQueryWorker worker{graph};
+    std::vector<std::uint64_t> seen;
+    auto result = WaitFor(worker, worker.Submit(10, 10, 90, 90), seen);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->path.status, RouteStatus::Found);
+    EXPECT_EQ(result->path.nodes, expected.nodes);
+    EXPECT_FALSE(worker.TakeResult());
+}
+
+
+// After a burst of queries the newest one always arrives, and the older results that get through come in order.
+TEST_F(RouteQueryWorkerTest, TestBurstKeepsNewestQuery) {
+    RouteQueryWorker worker{graph};
+    std::uint64_t last = 0;
+    for (int i = 0; i < 50; i++)
+        last = worker.Submit(10 + i % 5, 10, 90 - i % 7, 90);
+
+    std::vector<std::uint64_t> seen;
+    auto result = WaitFor(worker, last, seen);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->path.status, RouteStatus::Found);
+    for (size_t i = 1; i < seen.size(); i++)
+        EXPECT_LT(seen[i - 1], seen[i]);
+}
+
+
+// A set cancel flag stops the search with its own status.
+TEST_F(RouteQueryWorkerTest, TestCancelledSearch) {
+    SearchWorkspace workspace;
+    RoutePath path;
+    std::atomic<bool> cancel{true};
+    EXPECT_FALSE(FindShortestPath(graph, graph.FindClosestNode(0.1f, 0.1f), graph.FindClosestNode(0.9f, 0.9f),
+                                  workspace, path, nullptr, &cancel));
+    EXPECT_EQ(path.status, RouteStatus::Cancelled);
+    EXPECT_TRUE(path.Empty());
+}
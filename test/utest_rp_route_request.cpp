@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+#include <sstream>
+#include <string>
+#include "../src/json.h"
+#include "../src/route_request.h"
+
+//--------------------------------//
+//   Beginning RouteRequest Tests.
+//--------------------------------//
+
+// Nested values, escapes and numbers are parsed; trailing garbage is rejected.
+TEST(JsonTest, TestParse) {
+    auto value = ParseJson(R"( {"a": [1, -2.5e1, true, null], "b": "x\"é\n", "c": {}} )");
+    ASSERT_TRUE(value.has_value());
+    ASSERT_TRUE(value->IsObject());
+    const JsonValue *a = value->Find("a");
+    ASSERT_NE(a, nullptr);
+    ASSERT_EQ(a->array.size(), 4);
+    EXPECT_DOUBLE_EQ(a->array[1].number, -25.0);
+    EXPECT_EQ(value->Find("b")->string, "x\"\xc3\xa9\n");
+    EXPECT_EQ(value->Find("missing"), nullptr);
+
+    EXPECT_FALSE(ParseJson("{\"a\": 1} x").has_value());
+    EXPECT_FALSE(ParseJson("{\"a\": }").has_value());
+    EXPECT_FALSE(ParseJson("[1, 2").has_value());
+}
+
+
+// Numbers follow the JSON grammar, must be finite, and are written back exactly as they were given.
+TEST(JsonTest, TestNumbers) {
+    for (const char *text : {"+1", ".5", "1.", "01", "1e", "-", "inf", "1e999", "-1e999"})
+        EXPECT_FALSE(ParseJson(text).has_value()) << text;
+
+    for (const char *text : {"12345678", "-0.000123456789", "1E+30", "9007199254740993"}) {
+        auto value = ParseJson(text);
+        ASSERT_TRUE(value.has_value()) << text;
+        std::ostringstream os;
+        os.precision(7);
+        WriteJson(os, *value);
+        EXPECT_EQ(os.str(), text);
+    }
+
+    JsonValue built;
+    built.type = JsonValue::Type::Number;
+    built.number = 0.1;
+    std::ostringstream os;
+    WriteJson(os, built);
+    EXPECT_EQ(std::stod(os.str()), 0.1);
+}
+
+
+// A request line yields its id and coordinates, and the id is echoed back verbatim.
+TEST(RouteRequestTest, TestParseAndEcho) {
+    RouteRequest request;
+    std::string error;
+    ASSERT_TRUE(ParseRouteRequest(R"({"id": "q\"1", "start": [10, 20], "end": [90.5, 80]})", request, error));
+    EXPECT_FLOAT_EQ(request.query.start.x, 10.0f);
+    EXPECT_FLOAT_EQ(request.query.start.y, 20.0f);
+    EXPECT_FLOAT_EQ(request.query.end.x, 90.5f);
+    EXPECT_FLOAT_EQ(request.query.end.y, 80.0f);
+
+    std::ostringstream os;
+    WriteRouteError(os, request.id, "no route");
+    EXPECT_EQ(os.str(), "{\"id\":\"q\\\"1\",\"error\":\"no route\"}\n");
+
+    EXPECT_FALSE(ParseRouteRequest(R"({"start": [10], "end": [90, 90]})", request, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(ParseRouteRequest("not json", request, error));
+
+    // Numeric ids keep every digit, even through a stream set up for short distances.
+    ASSERT_TRUE(ParseRouteRequest(R"({"id": 12345678, "start": [10, 20], "end": [90, 80]})", request, error));
+    std::ostringstream numeric;
+    numeric.precision(7);
+    WriteRouteError(numeric, request.id, "no route");
+    EXPECT_EQ(numeric.str(), "{\"id\":12345678,\"error\":\"no route\"}\n");
+    EXPECT_FALSE(ParseRouteRequest(R"({"id": 1e999, "start": [10, 20], "end": [90, 80]})", request, error));
+}
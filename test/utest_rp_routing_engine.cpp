@@ -0,0 +1,132 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "../src/graph_search.h"
+#include "../src/route_model.h"
+#include "../src/routing_engine.h"
+
+//--------------------------------//
+//   Beginning RoutingEngine Tests.
+//--------------------------------//
+
+// A failed load leaves the engine without a model instead of throwing.
+TEST(RoutingEngineTest, TestFailedLoad) {
+    RoutingEngine engine;
+    EXPECT_FALSE(engine.Load("../does_not_exist.osm"));
+    EXPECT_EQ(engine.Acquire(), nullptr);
+    EXPECT_EQ(engine.Generation(), 0);
+}
+
+
+// Queries keep running across a reload; the old model is reclaimed once the last query released it.
+TEST(RoutingEngineTest, TestReloadWhileQuerying) {
+    RoutingEngine engine;
+    ASSERT_TRUE(engine.Load("../map.osm"));
+    EXPECT_EQ(engine.Generation(), 1);
+    std::weak_ptr<const RoadGraph> first = engine.Acquire();
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> failures{0}, queries{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++)
+        readers.emplace_back([&]() {
+            SearchWorkspace workspace;
+            RoutePath path;
+            while (!stop) {
+                auto pinned = engine.Acquire();
+                const RoadGraph &graph = *pinned;
+                if (!FindShortestPath(graph, graph.FindClosestNode(0.1f, 0.1f), graph.FindClosestNode(0.9f, 0.9f), workspace, path))
+                    failures++;
+                queries++;
+            }
+        });
+
+    ASSERT_TRUE(engine.ReloadAsync("../map.osm"));
+    while (engine.ReloadInProgress())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(engine.Generation(), 2);
+    EXPECT_NE(engine.Acquire(), nullptr);
+
+    stop = true;
+    for (auto &reader : readers)
+        reader.join();
+    EXPECT_GT(queries.load(), 0);
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_EQ(engine.Reclaim(), 0);
+    EXPECT_TRUE(first.expired());
+}
+
+
+// A caller that still pins a graph can publish a new one without waiting for itself.
+TEST(RoutingEngineTest, TestLoadWhileHoldingGraph) {
+    RoutingEngine engine;
+    ASSERT_TRUE(engine.Load("../map.osm", nullptr, 1));
+    auto held = engine.Acquire();
+    std::weak_ptr<const RoadGraph> first = held;
+
+    ASSERT_TRUE(engine.Load("../map.osm", nullptr, 1));
+    EXPECT_EQ(engine.Generation(), 2);
+    EXPECT_NE(engine.Acquire(), held);
+    EXPECT_GT(held->NodeCount(), 0);
+    EXPECT_EQ(engine.Reclaim(), 1);
+    EXPECT_FALSE(first.expired());
+
+    held.reset();
+    EXPECT_EQ(engine.Reclaim(), 0);
+    EXPECT_TRUE(first.expired());
+}
+
+
+// A mapped graph image is identical to the graph it was written from.
+TEST(RoutingEngineTest, TestGraphImage) {
+    std::ifstream is{"../map.osm", std::ios::binary | std::ios::ate};
+    std::vector<std::byte> data(is.tellg());
+    is.seekg(0);
+    is.read((char *)data.data(), data.size());
+    RouteModel model{data};
+    const RoadGraph &built = model.Graph();
+
+    std::string image = testing::TempDir() + "route_planner_test.graph";
+    ASSERT_TRUE(built.WriteImage(image));
+    ASSERT_TRUE(RoadGraph::IsImage(image));
+    EXPECT_FALSE(RoadGraph::IsImage("../map.osm"));
+    auto mapped = RoadGraph::MapImage(image);
+    ASSERT_TRUE(mapped.has_value());
+
+    ASSERT_EQ(mapped->NodeCount(), built.NodeCount());
+    ASSERT_EQ(mapped->EdgeCount(), built.EdgeCount());
+    EXPECT_EQ(mapped->MetricScale(), built.MetricScale());
+    for (int n = 0; n < built.NodeCount(); n++) {
+        ASSERT_EQ(mapped->Position(n).x, built.Position(n).x);
+        ASSERT_EQ(mapped->Position(n).y, built.Position(n).y);
+        ASSERT_EQ(mapped->EdgesEnd(n) - mapped->EdgesBegin(n), built.EdgesEnd(n) - built.EdgesBegin(n));
+    }
+    EXPECT_EQ(mapped->FindClosestNode(0.1f, 0.1f), built.FindClosestNode(0.1f, 0.1f));
+    EXPECT_EQ(mapped->FindClosestNode(0.9f, 0.9f), built.FindClosestNode(0.9f, 0.9f));
+
+    SearchWorkspace workspace;
+    RoutePath from_built, from_mapped;
+    ASSERT_TRUE(FindShortestPath(built, built.FindClosestNode(0.1f, 0.1f), built.FindClosestNode(0.9f, 0.9f), workspace, from_built));
+    ASSERT_TRUE(FindShortestPath(*mapped, mapped->FindClosestNode(0.1f, 0.1f), mapped->FindClosestNode(0.9f, 0.9f), workspace, from_mapped));
+    EXPECT_EQ(from_mapped.nodes, from_built.nodes);
+    EXPECT_FLOAT_EQ(from_mapped.Distance(), from_built.Distance());
+
+    // The engine attaches to the image the same way.
+    RoutingEngine engine;
+    ASSERT_TRUE(engine.Load(image));
+    EXPECT_EQ(engine.Acquire()->EdgeCount(), built.EdgeCount());
+
+    // A truncated image is rejected rather than mapped.
+    std::ifstream original{image, std::ios::binary};
+    std::string head(256, '\0');
+    original.read(head.data(), head.size());
+    original.close();
+    std::ofstream{image, std::ios::binary | std::ios::trunc}.write(head.data(), head.size());
+    EXPECT_FALSE(RoadGraph::MapImage(image).has_value());
+    EXPECT_FALSE(engine.Load(image));
+    std::remove(image.c_str());
+}
@@ -230,7 +230,9 @@ endfunction()
 # Set the CMake policy CMP0148 to NEW. This policy determines the behavior of the FindPythonInterp and FindPythonLibs modules.
 # As of CMake 3.12, these modules are deprecated and completely removed in CMake 3.19. Setting this policy to NEW means we are
 # acknowledging and preparing for this change.
-cmake_policy(SET CMP0148 NEW)
+if(POLICY CMP0148)
+  cmake_policy(SET CMP0148 NEW)
+endif()
 
 # cxx_test_with_flags(name cxx_flags libs srcs...)
 #